@@ -0,0 +1,279 @@
+#include "hanabi.hpp"
+
+//times the engine's hot paths and whole games with fixed seeds, printed as json or csv so runs can be compared between releases
+
+namespace
+{
+	template <typename T>
+	void keep(const T& value) //stops the compiler from removing work whose result is unused
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		const volatile auto* escape = &value;
+		static_cast<void>(escape);
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+	}
+
+	struct result
+	{
+		std::string name_;
+		std::uint64_t ops_per_sample_;
+		double median_ns_; //per op
+		double min_ns_;
+	};
+
+	struct settings
+	{
+		std::uint32_t seed = 3517219547;
+		bool csv = false;
+		double seconds_per_sample = 0.05;
+		int num_samples = 7;
+	};
+
+	//body() does one op, and is repeated until a sample takes seconds_per_sample. restart() runs untimed before each sample, so every sample sees the same input
+	template <typename Body, typename Restart>
+	result measure(std::string name, const settings& chosen, Body&& body, Restart&& restart)
+	{
+		using clock = std::chrono::steady_clock;
+
+		std::uint64_t ops = 1;
+		while (true)
+		{
+			restart();
+			const auto start = clock::now();
+			for (std::uint64_t op = 0; op < ops; ++op) body();
+			if (std::chrono::duration<double>(clock::now() - start).count() >= chosen.seconds_per_sample) break;
+			ops *= 2;
+		}
+
+		std::vector<double> ns_per_op;
+		for (int sample = 0; sample < chosen.num_samples; ++sample)
+		{
+			restart();
+			const auto start = clock::now();
+			for (std::uint64_t op = 0; op < ops; ++op) body();
+			ns_per_op.push_back(std::chrono::duration<double, std::nano>(clock::now() - start).count() / ops);
+		}
+
+		std::sort(ns_per_op.begin(), ns_per_op.end());
+		return { std::move(name), ops, ns_per_op[ns_per_op.size() / 2], ns_per_op.front() };
+	}
+
+	template <typename Body>
+	result measure(std::string name, const settings& chosen, Body&& body)
+	{
+		return measure(std::move(name), chosen, std::forward<Body>(body), []() {});
+	}
+
+	template <typename Configuration>
+	struct positions //states reached by random play, with every legal action from each, so single actions can be timed on realistic input
+	{
+		using actions_t = typename Configuration::template actions<std::variant>;
+
+		std::vector<hanabi::game_state<Configuration>> states_;
+		std::array<std::vector<std::pair<std::uint32_t, actions_t>>, 4> by_kind_; //play, discard, color hint, rank hint
+
+		positions(std::uint32_t seed, size_t num_games)
+		{
+			std::mt19937 gen(seed);
+
+			for (size_t game = 0; game < num_games; ++game)
+			{
+				auto state = hanabi::game<Configuration>::deal(gen);
+
+				while (!state.is_over())
+				{
+					const auto possible_actions = hanabi::find_all_possible_actions(state);
+
+					for (const auto& possible_action : possible_actions)
+					{
+						by_kind_[kind_of(possible_action)].emplace_back(static_cast<std::uint32_t>(states_.size()), possible_action);
+					}
+					states_.push_back(state);
+
+					std::uniform_int_distribution<size_t> dis(0, possible_actions.size() - 1);
+					state = std::visit([&](const auto& a) { return a.perform(state); }, possible_actions[dis(gen)]);
+				}
+			}
+		}
+
+		static size_t kind_of(const actions_t& any_action)
+		{
+			using configuration_t = typename hanabi::configuration::configuration_traits<Configuration>;
+			using code_t = hanabi::action_code<Configuration>;
+
+			const size_t code = code_t::encode(any_action);
+
+			if (code < 2 * configuration_t::deck_size) return code / configuration_t::deck_size;
+			return (code - 2 * configuration_t::deck_size) % code_t::num_properties < configuration_t::num_colors ? 2 : 3;
+		}
+	};
+
+	template <typename Configuration, typename Controller, typename Gen = std::mt19937>
+	result time_games(std::string name, const settings& chosen) //whole headless games, the same controller in every seat
+	{
+		Gen gen(chosen.seed);
+
+		return measure(std::move(name), chosen, [&]()
+			{
+				hanabi::game<Configuration, hanabi::history::compact<Configuration>> headless_game;
+				headless_game.init(gen);
+
+				[&] <size_t... Seats> (std::index_sequence<Seats...>)
+				{
+					headless_game.template run<std::tuple_element_t<Seats * 0, std::tuple<Controller>>...>(gen);
+				}(std::make_index_sequence<Configuration::num_players>{});
+
+				keep(headless_game.final_score());
+			}, [&]() { gen.seed(chosen.seed); });
+	}
+
+	template <typename Configuration>
+	void time_engine(const settings& chosen, std::vector<result>& results)
+	{
+		using game_t = hanabi::game<Configuration, hanabi::history::compact<Configuration>>;
+
+		std::mt19937 gen(chosen.seed);
+		const positions<Configuration> sampled(chosen.seed, 64);
+		constexpr std::array<std::string_view, 4> kind_names = { "play", "discard", "hint_color", "hint_rank" };
+
+		results.push_back(measure("game::init", chosen, [&]()
+			{
+				game_t dealt;
+				dealt.init(gen);
+				keep(dealt);
+			}, [&]() { gen.seed(chosen.seed); }));
+
+		std::uint64_t game_index = 0;
+		results.push_back(measure("game::init/rng::for_game", chosen, [&]() //a generator made for every deal, as batch::seeding::per_game does
+			{
+				auto per_game = hanabi::rng::for_game(chosen.seed, game_index++);
+				game_t dealt;
+				dealt.init(per_game);
+				keep(dealt);
+			}, [&]() { game_index = 0; }));
+
+		results.push_back(measure("game::init/stream_generator", chosen, [&]() //and the same with a seeded std::mt19937, as batch::seeding::streams would need
+			{
+				auto per_game = hanabi::batch::stream_generator(chosen.seed, game_index++);
+				game_t dealt;
+				dealt.init(per_game);
+				keep(dealt);
+			}, [&]() { game_index = 0; }));
+
+		for (size_t kind = 0; kind < kind_names.size(); ++kind)
+		{
+			const auto& pairs = sampled.by_kind_[kind];
+			size_t next = 0;
+
+			results.push_back(measure(std::string(kind_names[kind]) + "::validate", chosen, [&]()
+				{
+					const auto& [state, taken] = pairs[next++ % pairs.size()];
+					keep(std::visit([&](const auto& a) { return a.validate(sampled.states_[state]); }, taken));
+				}));
+
+			results.push_back(measure(std::string(kind_names[kind]) + "::perform", chosen, [&]()
+				{
+					const auto& [state, taken] = pairs[next++ % pairs.size()];
+					keep(std::visit([&](const auto& a) { return a.perform(sampled.states_[state]); }, taken));
+				}));
+		}
+
+		size_t next = 0;
+		results.push_back(measure("find_all_possible_actions", chosen, [&]()
+			{
+				keep(hanabi::find_all_possible_actions(sampled.states_[next++ % sampled.states_.size()]));
+			}));
+
+		const auto& plays = sampled.by_kind_[0];
+		results.push_back(measure("play::is_playable", chosen, [&]()
+			{
+				const auto& [state, taken] = plays[next++ % plays.size()];
+				keep(std::get<hanabi::action<hanabi::play>>(taken).a_.is_playable(sampled.states_[state]));
+			}));
+
+		results.push_back(measure("game::score_of", chosen, [&]()
+			{
+				keep(game_t::score_of(sampled.states_[next++ % sampled.states_.size()]));
+			}));
+
+		results.push_back(measure("deal_sampler::deal_sampler", chosen, [&]()
+			{
+				const auto& state = sampled.states_[next++ % sampled.states_.size()];
+				keep(hanabi::deal_sampler<Configuration>(state, state.player_turn_).num_hands());
+			}));
+
+		std::vector<hanabi::deal_sampler<Configuration>> samplers;
+		for (size_t i = 0; i < sampled.states_.size(); i += 16) samplers.emplace_back(sampled.states_[i], sampled.states_[i].player_turn_);
+		std::array<std::uint8_t, hanabi::configuration::configuration_traits<Configuration>::deck_size> deal;
+
+		results.push_back(measure("deal_sampler::sample", chosen, [&]()
+			{
+				const auto& sampler = samplers[next++ % samplers.size()];
+				sampler.sample(gen, std::span<std::uint8_t>(deal.data(), sampler.num_hidden()));
+				keep(deal);
+			}));
+	}
+
+	template <typename Configuration>
+	void time_random_games(const settings& chosen, std::vector<result>& results)
+	{
+		results.push_back(time_games<Configuration, hanabi::controller::random_ai<Configuration>>("game::run/random/" + std::to_string(Configuration::num_players) + "p", chosen));
+	}
+
+	void print(std::ostream& stream, const settings& chosen, const std::vector<result>& results)
+	{
+		if (chosen.csv)
+		{
+			stream << "name,ops_per_sample,median_ns,min_ns,ops_per_second\n";
+			for (const auto& timed : results)
+			{
+				stream << timed.name_ << ',' << timed.ops_per_sample_ << ',' << timed.median_ns_ << ',' << timed.min_ns_ << ',' << 1e9 / timed.median_ns_ << '\n';
+			}
+			return;
+		}
+
+		stream << "{\n  \"seed\": " << chosen.seed << ",\n  \"samples\": " << chosen.num_samples << ",\n  \"benchmarks\": [\n";
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const auto& timed = results[i];
+			stream << "    { \"name\": \"" << timed.name_ << "\", \"ops_per_sample\": " << timed.ops_per_sample_ << ", \"median_ns\": " << timed.median_ns_
+				<< ", \"min_ns\": " << timed.min_ns_ << ", \"ops_per_second\": " << 1e9 / timed.median_ns_ << " }" << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		stream << "  ]\n}\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	settings chosen;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		const std::string_view option = argv[i];
+
+		if (option == "--seed") chosen.seed = static_cast<std::uint32_t>(std::stoul(argv[i + 1]));
+		else if (option == "--format" && (argv[i + 1] == std::string_view("json") || argv[i + 1] == std::string_view("csv"))) chosen.csv = argv[i + 1] == std::string_view("csv");
+		else if (option == "--samples") chosen.num_samples = std::max(1, std::stoi(argv[i + 1]));
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [--seed <seed>] [--format json|csv] [--samples <num samples>]\n";
+			return 1;
+		}
+	}
+
+	std::vector<result> results;
+
+	time_engine<hanabi::configuration::default_t>(chosen, results);
+	time_random_games<hanabi::configuration::default_t>(chosen, results);
+	time_random_games<hanabi::configuration::players<3>>(chosen, results);
+	time_random_games<hanabi::configuration::players<4>>(chosen, results);
+	time_random_games<hanabi::configuration::players<5>>(chosen, results);
+	results.push_back(time_games<hanabi::configuration::default_t, hanabi::controller::rule_based<hanabi::configuration::default_t>>("game::run/rule/2p", chosen));
+	results.push_back(time_games<hanabi::configuration::default_t, hanabi::controller::random_ai<hanabi::configuration::default_t>, hanabi::rng::xoshiro256ss>("game::run/random/2p/xoshiro256ss", chosen));
+
+	print(std::cout, chosen, results);
+	return 0;
+}
@@ -0,0 +1,4937 @@
+#pragma once
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <random>
+#include <variant>
+#include <array>
+#include <tuple>
+#include <optional>
+#include <iostream>
+#include <termcolor/termcolor.hpp>
+#include <string_view>
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <bit>
+#include <span>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <iterator>
+#include <sstream>
+#include <cstdio>
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <deque>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+template <typename T>
+struct dependent_false : std::false_type {};
+
+namespace hanabi
+{
+	namespace rng //generators small enough to make one per game. anything meeting UniformRandomBitGenerator works wherever a Gen is taken
+	{
+		class splitmix64 //output n is a hash of seed + n * gamma, so the sequence can be entered anywhere
+		{
+		public:
+
+			using result_type = std::uint64_t;
+
+			static constexpr std::uint64_t gamma = 0x9E3779B97F4A7C15;
+
+			constexpr explicit splitmix64(std::uint64_t seed = 0) : state_(seed)
+			{
+			}
+
+			static constexpr result_type min() { return 0; }
+			static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+			constexpr result_type operator()()
+			{
+				auto z = (state_ += gamma);
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+				return z ^ (z >> 31);
+			}
+
+			constexpr void discard(std::uint64_t n)
+			{
+				state_ += n * gamma;
+			}
+
+		private:
+			std::uint64_t state_;
+		};
+
+		class xoshiro256ss //xoshiro256**, 32 bytes of state against the 2.5 KB of std::mt19937, and seeded with four splitmix64 outputs
+		{
+		public:
+
+			using result_type = std::uint64_t;
+
+			constexpr explicit xoshiro256ss(std::uint64_t value = 0)
+			{
+				seed(value);
+			}
+
+			constexpr void seed(std::uint64_t value)
+			{
+				splitmix64 expand(value);
+				for (auto& word : state_) word = expand();
+			}
+
+			static constexpr result_type min() { return 0; }
+			static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+			constexpr result_type operator()()
+			{
+				const auto result = std::rotl(state_[1] * 5, 7) * 9;
+				const auto shifted = state_[1] << 17;
+
+				state_[2] ^= state_[0];
+				state_[3] ^= state_[1];
+				state_[1] ^= state_[2];
+				state_[0] ^= state_[3];
+				state_[2] ^= shifted;
+				state_[3] = std::rotl(state_[3], 45);
+
+				return result;
+			}
+
+		private:
+			std::array<std::uint64_t, 4> state_{};
+		};
+
+		//counter based: game i of a base seed gets a generator that depends on (base_seed, i) alone,
+		//so any game of a run can be dealt and played again without the games before it
+		constexpr xoshiro256ss for_game(std::uint64_t base_seed, std::uint64_t game)
+		{
+			splitmix64 key(base_seed);
+			splitmix64 keyed(key()); //hashed first, so nearby base seeds do not share games
+			keyed.discard(game);
+			return xoshiro256ss(keyed());
+		}
+	}
+
+	namespace parallel
+	{
+		class worker_pool //threads kept between calls. each call is split into chunks that the workers and the calling thread take in turn
+		{
+		public:
+
+			explicit worker_pool(unsigned num_threads)
+			{
+				for (unsigned worker = 1; worker < num_threads; ++worker)
+				{
+					workers_.emplace_back([this](std::stop_token stop) { work(stop); });
+				}
+			}
+
+			worker_pool(const worker_pool&) = delete;
+			worker_pool& operator=(const worker_pool&) = delete;
+
+			template <typename Task> //task(chunk) for every chunk below num_chunks, returns once all are done
+			void run(size_t num_chunks, const Task& task)
+			{
+				{
+					std::scoped_lock lock(mutex_);
+					task_ = &task;
+					call_ = [](const void* erased, size_t chunk) { (*static_cast<const Task*>(erased))(chunk); };
+					num_chunks_ = num_chunks;
+					next_chunk_ = 0;
+					++generation_;
+				}
+				wake_.notify_all();
+
+				take_chunks();
+
+				std::unique_lock lock(mutex_);
+				finished_.wait(lock, [&] { return num_working_ == 0; });
+			}
+
+		private:
+
+			void take_chunks()
+			{
+				for (auto chunk = next_chunk_++; chunk < num_chunks_; chunk = next_chunk_++) call_(task_, chunk);
+			}
+
+			void work(std::stop_token stop)
+			{
+				std::uint64_t seen = 0;
+
+				while (true)
+				{
+					{
+						std::unique_lock lock(mutex_);
+						if (!wake_.wait(lock, stop, [&] { return generation_ != seen; })) return;
+
+						seen = generation_;
+						if (next_chunk_ >= num_chunks_) continue; //woke after the others had finished, joining now could race the next call
+						++num_working_;
+					}
+
+					take_chunks();
+
+					{
+						std::scoped_lock lock(mutex_);
+						--num_working_;
+					}
+					finished_.notify_one();
+				}
+			}
+
+			std::mutex mutex_;
+			std::condition_variable_any wake_;
+			std::condition_variable finished_;
+
+			const void* task_ = nullptr;
+			void (*call_)(const void*, size_t) = nullptr;
+			size_t num_chunks_ = 0;
+			std::atomic<size_t> next_chunk_ = 0;
+			std::uint64_t generation_ = 0;
+			unsigned num_working_ = 0;
+
+			std::vector<std::jthread> workers_; //last, so the threads are stopped before anything they use is destroyed
+		};
+	}
+
+	namespace sink //where game::run renders a watched game
+	{
+		struct null //a headless game, every bit of display code is compiled out
+		{
+			static constexpr bool enabled = false;
+		};
+
+		inline bool is_terminal(const std::ostream& target) noexcept //the check termcolor makes before it colors std::cout or std::cerr
+		{
+			FILE* file = &target == &std::cout ? stdout : (&target == &std::cerr || &target == &std::clog) ? stderr : nullptr;
+#if defined(_WIN32)
+			return file != nullptr && _isatty(_fileno(file));
+#else
+			return file != nullptr && ::isatty(::fileno(file));
+#endif
+		}
+
+		class frame //each frame is formatted in memory and written to the target with a single call
+		{
+		public:
+
+			static constexpr bool enabled = true;
+
+			explicit frame(std::ostream& target) : target_(target)
+			{
+				if (is_terminal(target)) buffer_ << termcolor::colorize; //termcolor only colors a string stream when told to
+			}
+
+			std::ostream& stream() noexcept
+			{
+				return buffer_;
+			}
+
+			void flush()
+			{
+				const auto text = buffer_.view();
+				target_.write(text.data(), static_cast<std::streamsize>(text.size()));
+				target_.flush();
+				buffer_.str({});
+			}
+
+		private:
+
+			std::ostream& target_;
+			std::ostringstream buffer_;
+		};
+	}
+
+	constexpr std::string_view rank_name(size_t n)
+	{
+		using namespace std::string_view_literals;
+		switch (n)
+		{
+		case 0: return "1"sv;
+		case 1: return "2"sv;
+		case 2: return "3"sv;
+		case 3: return "4"sv;
+		case 4: return "5"sv;
+		default: throw std::runtime_error("Unexpected rank.");
+		}
+	}
+
+	template <size_t N>
+	struct rank 
+	{
+		constexpr static std::string_view display_rank()
+		{
+			return rank_name(N);
+		}
+	};
+
+	constexpr auto termcolor_color(size_t n)
+	{
+		switch (n)
+		{
+		case 0: return termcolor::red;
+		case 1: return termcolor::green;
+		case 2: return termcolor::yellow;
+		case 3: return termcolor::cyan;
+		case 4: return termcolor::white;
+		default: throw std::runtime_error("Unexpected color.");
+		}
+	}
+
+	constexpr auto termcolor_on_color(size_t n)
+	{
+		switch (n)
+		{
+		case 0: return termcolor::on_red;
+		case 1: return termcolor::on_green;
+		case 2: return termcolor::on_yellow;
+		case 3: return termcolor::on_cyan;
+		case 4: return termcolor::on_white;
+		default: throw std::runtime_error("Unexpected color.");
+		}
+	}
+
+	constexpr auto color_name(size_t n)
+	{
+		using namespace std::string_view_literals;
+		switch (n)
+		{
+		case 0: return "red"sv;
+		case 1: return "green"sv;
+		case 2: return "yellow"sv;
+		case 3: return "cyan"sv;
+		case 4: return "white"sv;
+		default: throw std::runtime_error("Unexpected color.");
+		}
+	}
+
+
+	template <size_t N> 
+	struct color 
+	{
+		constexpr static auto display_name()
+		{
+			return color_name(N);
+		}
+
+		constexpr static auto display_color()
+		{
+			return termcolor_color(N);
+		}
+
+		constexpr static auto display_on_color()
+		{
+			return termcolor_on_color(N);
+		}
+	};
+
+	namespace location
+	{
+		struct draw_pile {};
+		struct discard_pile {};
+		struct in_play {};
+		struct hand { int player_; };
+	}
+
+	template <typename Action> struct action;
+	struct play;
+	template <typename Property> struct hint;
+	struct discard;
+
+	template <typename CardInfo, typename Is>
+	struct card_frequency_impl;
+
+	template <typename CardInfo, size_t... Ns>
+	struct card_frequency_impl <CardInfo, std::index_sequence<Ns...>>
+	{
+		using tuple = std::tuple<std::enable_if_t<Ns == Ns, CardInfo>...>;
+	};
+
+	template <typename Color, typename Rank>
+	struct card_info {};
+
+	template <typename Color, typename Rank, size_t Freq> 
+	struct card_frequency 
+	{
+		using tuple = typename card_frequency_impl<card_info<Color, Rank>, std::make_index_sequence<Freq>>::tuple;
+	};
+
+	template <typename Property, typename... Properties>
+	constexpr size_t index_of_property()
+	{
+		size_t index = 0;
+		[[maybe_unused]] const bool found = ((std::is_same_v<Property, Properties> || (++index, false)) || ...);
+		return index;
+	}
+
+	template <typename Property>
+	struct index_of_this_property
+	{
+		template <typename... Properties>
+		using type = std::integral_constant<size_t, index_of_property<Property, Properties...>()>;
+	};
+
+	template <typename Variant, size_t... Ns>
+	constexpr Variant variant_from_index_impl(size_t index, std::index_sequence<Ns...>)
+	{
+		constexpr std::array<Variant(*)(), sizeof...(Ns)> alternatives{ []() { return Variant{ std::in_place_index<Ns> }; }... };
+		return alternatives[index]();
+	}
+
+	template <typename Variant>
+	constexpr Variant variant_from_index(size_t index)
+	{
+		return variant_from_index_impl<Variant>(index, std::make_index_sequence<std::variant_size_v<Variant>>{});
+	}
+
+	namespace configuration
+	{
+		template <typename Configuration>
+		struct configuration_traits
+		{
+			static constexpr size_t num_players = Configuration::num_players;
+			static constexpr size_t hand_size = Configuration::hand_size;
+			static constexpr int max_num_hints = Configuration::max_num_hints;
+			static constexpr int starting_num_hints = Configuration::starting_num_hints;
+			static constexpr int max_num_mistakes = Configuration::max_num_mistakes;
+
+			template <template <typename... TArgs> typename Container>
+			using ranks = typename Configuration::template ranks<Container>;
+
+			template <template <typename... TArgs> typename Container>
+			using colors = typename Configuration::template colors<Container>;
+
+			template <template <typename... TArgs> typename Container>
+			using locations = typename Configuration::template locations<Container>;
+
+			template <template <typename... TArgs> typename Container>
+			using actions = typename Configuration::template actions<Container>;
+
+			using card_frequencies = typename Configuration::card_frequencies;
+
+			static constexpr size_t num_colors = std::tuple_size_v<colors<std::tuple>>;
+			static constexpr size_t num_ranks = std::tuple_size_v<ranks<std::tuple>>;
+			static constexpr size_t max_score = num_colors * num_ranks;
+			static constexpr size_t max_num_actions = 2 * hand_size + (num_players - 1) * (num_colors + num_ranks); //play or discard each card, hint every property to every partner
+
+			template <typename Color>
+			static constexpr size_t color_index = colors<index_of_this_property<Color>::template type>::value;
+
+			template <typename Rank>
+			static constexpr size_t rank_index = ranks<index_of_this_property<Rank>::template type>::value;
+
+			template <typename Location>
+			static constexpr size_t location_index = locations<index_of_this_property<Location>::template type>::value;
+
+			static constexpr size_t deck_size = []()
+			{
+				return [] <typename... Colors, typename... Ranks, size_t... Freqs> (std::tuple<card_frequency<Colors, Ranks, Freqs>...>&&)
+				{
+					return (Freqs + ...);
+				} (card_frequencies{});
+			}();
+		};
+
+		struct default_t
+		{
+			static constexpr auto num_players = 2;
+			static constexpr auto hand_size = 5;
+			static constexpr auto max_num_hints = 8;
+			static constexpr auto starting_num_hints = 8;
+			static constexpr auto max_num_mistakes = 3;
+
+
+			template <template <typename... TArgs> typename Container> //for use with std::variant, std::tuple, etc.
+			using ranks = Container<rank<0>, rank<1>, rank<2>, rank<3>, rank<4>>;
+	
+			template <template <typename... TArgs> typename Container>
+			using colors = Container<color<0>, color<1>, color<2>, color<3>, color<4>>;
+
+			template <template <typename... TArgs> typename Container>
+			using locations = Container<location::draw_pile, location::hand, location::discard_pile, location::in_play>;
+
+			template <template <typename... TArgs> typename Container>
+			using actions = Container<action<play>, action<discard>,
+				hint<color<0>>, hint<color<1>>, hint<color<2>>, hint<color<3>>, hint<color<4>>,
+				hint<rank<0>>, hint<rank<1>>, hint<rank<2>>, hint<rank<3>>, hint<rank<4>>>;
+
+			using card_frequencies = std::tuple<
+
+				card_frequency<color<0>, rank<0>, 3>, card_frequency<color<0>, rank<1>, 2>, card_frequency<color<0>, rank<2>, 2>,
+				card_frequency<color<0>, rank<3>, 2>, card_frequency<color<0>, rank<4>, 1>,
+				
+				card_frequency<color<1>, rank<0>, 3>, card_frequency<color<1>, rank<1>, 2>, card_frequency<color<1>, rank<2>, 2>,
+				card_frequency<color<1>, rank<3>, 2>, card_frequency<color<1>, rank<4>, 1>,
+				
+				card_frequency<color<2>, rank<0>, 3>, card_frequency<color<2>, rank<1>, 2>, card_frequency<color<2>, rank<2>, 2>,
+				card_frequency<color<2>, rank<3>, 2>, card_frequency<color<2>, rank<4>, 1>,
+				
+				card_frequency<color<3>, rank<0>, 3>, card_frequency<color<3>, rank<1>, 2>, card_frequency<color<3>, rank<2>, 2>,
+				card_frequency<color<3>, rank<3>, 2>, card_frequency<color<3>, rank<4>, 1>,
+				
+				card_frequency<color<4>, rank<0>, 3>, card_frequency<color<4>, rank<1>, 2>, card_frequency<color<4>, rank<2>, 2>,
+				card_frequency<color<4>, rank<3>, 2>, card_frequency<color<4>, rank<4>, 1>
+			>;
+		};
+
+		template <size_t NumPlayers>
+		struct players : default_t //the default deck at a table of NumPlayers
+		{
+			static_assert(NumPlayers >= 2 && NumPlayers <= 5, "Hanabi is played by 2 to 5 players.");
+
+			static constexpr auto num_players = NumPlayers;
+			static constexpr auto hand_size = NumPlayers <= 3 ? 5 : 4;
+		};
+	}
+
+	template <typename Configuration>
+	struct card
+	{
+		typename Configuration::template colors<std::variant> color_;
+		typename Configuration::template ranks<std::variant> rank_;
+
+		std::ostream& display_card(std::ostream& stream) const
+		{
+			const auto rank_display = std::visit([](const auto& r) { return r.display_rank(); }, rank_);
+			const auto color_on_display = std::visit([](const auto& c) { return c.display_on_color(); }, color_);
+
+			stream << color_on_display << termcolor::grey << rank_display << termcolor::reset;
+
+			return stream;
+		}
+	};
+
+	template <typename Property>
+	struct contains_this_property
+	{
+		template <typename... Properties>
+		using type = std::disjunction<std::is_same<Property, Properties>...>;
+	};
+
+	template <typename Property, typename Configuration>
+	using is_property_a_color = typename Configuration::template colors<contains_this_property<Property>::template type>;
+
+	template <typename Property, typename Configuration>
+	inline constexpr bool is_property_a_color_v = is_property_a_color<Property, Configuration>::value;
+
+	template <typename Property, typename Configuration>
+	using is_property_a_rank = typename Configuration::template ranks<contains_this_property<Property>::template type>;
+	
+	template <typename Property, typename Configuration>
+	inline constexpr bool is_property_a_rank_v = is_property_a_rank<Property, Configuration>::value;
+
+	template <typename Property, typename Configuration>
+	constexpr std::uint8_t property_bit()
+	{
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+		if constexpr (is_property_a_color_v<Property, Configuration> != is_property_a_rank_v<Property, Configuration>)
+		{
+			if constexpr (is_property_a_color_v<Property, Configuration>)
+			{
+				return static_cast<std::uint8_t>(1u << configuration_t::template color_index<Property>);
+			}
+			else
+			{
+				return static_cast<std::uint8_t>(1u << configuration_t::template rank_index<Property>);
+			}
+		}
+		else
+		{
+			static_assert(dependent_false<Configuration>::value, "Hint for this property is ill-formed. Hint can neither be for both rank or color (and must be at least one).");
+		}
+	}
+
+	template <typename Configuration>
+	struct knowledge
+	{
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+		static_assert(configuration_t::num_colors <= 8 && configuration_t::num_ranks <= 8, "Hinted colors and ranks are stored as a byte mask each.");
+
+		static constexpr std::uint8_t all_colors = static_cast<std::uint8_t>((1u << configuration_t::num_colors) - 1);
+		static constexpr std::uint8_t all_ranks = static_cast<std::uint8_t>((1u << configuration_t::num_ranks) - 1);
+
+		std::uint8_t hinted_colors_ = all_colors; //bit n is set while color<n> is still possible
+		std::uint8_t hinted_ranks_ = all_ranks; //bit n is set while rank<n> is still possible
+		bool clued_ = false; //a hint has named this card, negative hints alone can narrow the masks just as far
+
+		constexpr bool is_color_possible(size_t color_index) const noexcept
+		{
+			return (hinted_colors_ >> color_index) & 1u;
+		}
+
+		constexpr bool is_rank_possible(size_t rank_index) const noexcept
+		{
+			return (hinted_ranks_ >> rank_index) & 1u;
+		}
+	};
+
+	template <typename Configuration>
+	struct card_state
+	{
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+		using locations_t = typename Configuration::template locations<std::variant>;
+
+		static constexpr unsigned location_bits = 2;
+
+		static_assert(std::variant_size_v<locations_t> <= (1u << location_bits), "Location index must fit in the low location bits.");
+		static_assert((configuration_t::num_players << location_bits) <= 256, "Owning player must fit in the high location bits.");
+		static_assert(configuration_t::num_colors * configuration_t::num_ranks <= 256, "Card identity must fit in a byte.");
+
+		std::uint8_t identity_; //color index * num_ranks + rank index
+		std::uint8_t location_; //index into locations_t, the owning player is stored above location_bits for location::hand
+		knowledge<Configuration> knowledge_;
+
+		template <typename Color, typename Rank>
+		static constexpr std::uint8_t identity_of()
+		{
+			return static_cast<std::uint8_t>(configuration_t::template color_index<Color> * configuration_t::num_ranks + configuration_t::template rank_index<Rank>);
+		}
+
+		static constexpr card<Configuration> card_of(std::uint8_t identity)
+		{
+			return card<Configuration>{
+				variant_from_index<typename Configuration::template colors<std::variant>>(identity / configuration_t::num_ranks),
+				variant_from_index<typename Configuration::template ranks<std::variant>>(identity % configuration_t::num_ranks) };
+		}
+
+		template <typename Location>
+		static constexpr std::uint8_t location_code(const Location& where) noexcept
+		{
+			if constexpr (std::is_same_v<Location, location::hand>)
+			{
+				return static_cast<std::uint8_t>(configuration_t::template location_index<Location> | (where.player_ << location_bits));
+			}
+			else
+			{
+				return static_cast<std::uint8_t>(configuration_t::template location_index<Location>);
+			}
+		}
+
+		constexpr size_t color_index() const noexcept
+		{
+			return identity_ / configuration_t::num_ranks;
+		}
+
+		constexpr size_t rank_index() const noexcept
+		{
+			return identity_ % configuration_t::num_ranks;
+		}
+
+		constexpr card<Configuration> get_card() const
+		{
+			return card_of(identity_);
+		}
+
+		constexpr locations_t get_location() const
+		{
+			auto where = variant_from_index<locations_t>(location_ & ((1u << location_bits) - 1));
+
+			if (auto in_hand = std::get_if<location::hand>(&where); in_hand)
+			{
+				in_hand->player_ = location_ >> location_bits;
+			}
+
+			return where;
+		}
+
+		template <typename Location>
+		constexpr void move_to(const Location& where) noexcept
+		{
+			location_ = location_code(where);
+		}
+
+		constexpr bool is_in_draw_pile() const noexcept
+		{
+			return location_ == location_code(location::draw_pile{});
+		}
+
+		constexpr bool is_in_discard_pile() const noexcept
+		{
+			return location_ == location_code(location::discard_pile{});
+		}
+
+		constexpr bool is_in_play() const noexcept
+		{
+			return location_ == location_code(location::in_play{});
+		}
+
+		constexpr bool is_in_hand() const noexcept
+		{
+			return (location_ & ((1u << location_bits) - 1)) == configuration_t::template location_index<location::hand>;
+		}
+
+		constexpr bool is_in_hand_of(int player) const noexcept
+		{
+			return location_ == location_code(location::hand{ player });
+		}
+	};
+
+	template <typename Property, typename Configuration>
+	constexpr bool has_property(const card_state<Configuration>& card_in_deck) noexcept
+	{
+		if constexpr (is_property_a_color_v<Property, Configuration>)
+		{
+			return card_in_deck.color_index() == configuration::configuration_traits<Configuration>::template color_index<Property>;
+		}
+		else
+		{
+			return card_in_deck.rank_index() == configuration::configuration_traits<Configuration>::template rank_index<Property>;
+		}
+	}
+
+	template <typename Configuration>
+	struct deck_state
+	{
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+		std::array<card_state<Configuration>, configuration_t::deck_size> cards_;
+	};
+
+	template <typename Configuration>
+	struct game_state;
+
+	template <typename Configuration>
+	class zobrist //a 64 bit key for every value each part of a game_state can take, so a state hash can be kept up to date with a few xors
+	{
+	public:
+
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+		static constexpr size_t num_location_codes = configuration_t::num_players << card_state<Configuration>::location_bits;
+		static constexpr size_t num_knowledge_bits = 17; //hinted_colors_ in the low byte, hinted_ranks_ in the high byte, then clued_
+
+		static constexpr std::uint64_t location(size_t card, std::uint8_t location_code)
+		{
+			return keys_[card * num_location_codes + location_code];
+		}
+
+		static constexpr std::uint64_t knowledge_change(size_t card, const knowledge<Configuration>& before, const knowledge<Configuration>& after)
+		{
+			std::uint64_t change = 0;
+
+			for (unsigned bits = (before.hinted_colors_ ^ after.hinted_colors_) | ((before.hinted_ranks_ ^ after.hinted_ranks_) << 8) | (unsigned{ before.clued_ != after.clued_ } << 16); bits != 0; bits &= bits - 1)
+			{
+				change ^= keys_[knowledge_offset + card * num_knowledge_bits + std::countr_zero(bits)];
+			}
+
+			return change;
+		}
+
+		static constexpr std::uint64_t knowledge_of(size_t card, const knowledge<Configuration>& known)
+		{
+			return knowledge_change(card, knowledge<Configuration>{ 0, 0, false }, known);
+		}
+
+		static constexpr std::uint64_t counters(const game_state<Configuration>& state) //everything but the cards
+		{
+			return keys_[hints_offset + state.num_available_hints_]
+				^ keys_[mistakes_offset + state.num_mistakes_]
+				^ keys_[turn_offset + state.player_turn_]
+				^ keys_[draw_offset + state.next_card_to_draw_.value_or(static_cast<int>(configuration_t::deck_size))]
+				^ keys_[last_player_offset + state.last_player_to_play_.value_or(static_cast<int>(configuration_t::num_players))]
+				^ (state.last_player_has_played_ ? keys_[last_player_has_played_offset] : 0);
+		}
+
+	private:
+
+		static constexpr size_t knowledge_offset = configuration_t::deck_size * num_location_codes;
+		static constexpr size_t hints_offset = knowledge_offset + configuration_t::deck_size * num_knowledge_bits;
+		static constexpr size_t mistakes_offset = hints_offset + configuration_t::max_num_hints + 1;
+		static constexpr size_t turn_offset = mistakes_offset + configuration_t::max_num_mistakes + 1;
+		static constexpr size_t draw_offset = turn_offset + configuration_t::num_players;
+		static constexpr size_t last_player_offset = draw_offset + configuration_t::deck_size + 1;
+		static constexpr size_t last_player_has_played_offset = last_player_offset + configuration_t::num_players + 1;
+		static constexpr size_t num_keys = last_player_has_played_offset + 1;
+
+		static constexpr std::array<std::uint64_t, num_keys> keys_ = []()
+		{
+			std::array<std::uint64_t, num_keys> keys{};
+			rng::splitmix64 expand(rng::splitmix64::gamma);
+
+			for (auto& key : keys) key = expand();
+
+			return keys;
+		}();
+	};
+
+	template <typename Configuration>
+	struct undo_record //everything an action may change, captured before it is applied
+	{
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+		std::array<std::uint8_t, configuration_t::hand_size> hand_; //hand of the acting player, or of the hinted player
+		std::array<knowledge<Configuration>, configuration_t::hand_size> knowledge_; //knowledge of that hand, only filled in by hints
+		std::uint8_t hand_size_;
+		int player_turn_;
+		int num_available_hints_;
+		int num_mistakes_;
+		std::optional<int> next_card_to_draw_;
+		std::optional<int> last_player_to_play_;
+		bool last_player_has_played_;
+		std::uint64_t hash_;
+	};
+
+	template <typename Configuration>
+	struct game_state
+	{
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+		deck_state<Configuration> deck_;
+		std::array<std::uint8_t, configuration_t::num_colors> fireworks_; //number of cards played so far in each color
+		std::array<std::array<std::uint8_t, configuration_t::hand_size>, configuration_t::num_players> hands_; //deck indices of each hand, oldest draw first
+		std::array<std::uint8_t, configuration_t::num_players> hand_sizes_;
+		int player_turn_;
+		int num_available_hints_;
+		int num_mistakes_;
+		std::optional<int> next_card_to_draw_;
+		std::optional<int> last_player_to_play_;
+		bool last_player_has_played_;
+		std::uint64_t hash_; //zobrist hash of all of the above, updated by every action
+
+		constexpr std::uint64_t compute_hash() const
+		{
+			auto hash = zobrist<Configuration>::counters(*this);
+
+			for (size_t card = 0; card < deck_.cards_.size(); ++card)
+			{
+				hash ^= zobrist<Configuration>::location(card, deck_.cards_[card].location_) ^ zobrist<Configuration>::knowledge_of(card, deck_.cards_[card].knowledge_);
+			}
+
+			return hash;
+		}
+
+		template <typename Location>
+		constexpr void move_card(int card, const Location& where)
+		{
+			auto& moved_card = deck_.cards_[card];
+			hash_ ^= zobrist<Configuration>::location(card, moved_card.location_);
+			moved_card.move_to(where);
+			hash_ ^= zobrist<Configuration>::location(card, moved_card.location_);
+		}
+
+		constexpr void set_knowledge(int card, const knowledge<Configuration>& known)
+		{
+			hash_ ^= zobrist<Configuration>::knowledge_change(card, deck_.cards_[card].knowledge_, known);
+			deck_.cards_[card].knowledge_ = known;
+		}
+
+		constexpr std::span<const std::uint8_t> hand_of(int player) const noexcept
+		{
+			return { hands_[player].data(), hand_sizes_[player] };
+		}
+
+		constexpr void add_to_hand(int player, int card)
+		{
+			move_card(card, location::hand{ player });
+			hands_[player][hand_sizes_[player]++] = static_cast<std::uint8_t>(card);
+		}
+
+		constexpr void remove_from_hand(int player, int card)
+		{
+			auto& hand = hands_[player];
+			const auto end = hand.begin() + hand_sizes_[player];
+
+			std::shift_left(std::find(hand.begin(), end, static_cast<std::uint8_t>(card)), end, 1);
+			--hand_sizes_[player];
+		}
+
+		constexpr void draw_card() //the current player draws the next card from the deck, if there is one
+		{
+			if (!next_card_to_draw_.has_value()) return;
+
+			if (!deck_.cards_[next_card_to_draw_.value()].is_in_draw_pile())
+			{
+				throw std::runtime_error("Next card to draw was not in the deck");
+			}
+
+			add_to_hand(player_turn_, next_card_to_draw_.value());
+
+			++next_card_to_draw_.value();
+			if (next_card_to_draw_.value() >= deck_.cards_.size())
+			{
+				next_card_to_draw_ = std::nullopt;
+				last_player_to_play_ = player_turn_;
+			}
+		}
+
+		constexpr int score() const
+		{
+			return std::accumulate(fireworks_.begin(), fireworks_.end(), 0);
+		}
+
+		constexpr bool is_over() const
+		{
+			const bool too_many_mistakes = num_mistakes_ >= configuration_t::max_num_mistakes;
+			const bool last_turn_has_happened = last_player_has_played_;
+			const bool no_more_possible_moves = score() == configuration_t::max_score;
+
+			return too_many_mistakes || last_turn_has_happened || no_more_possible_moves;
+		}
+
+		static constexpr int next_player(int player) noexcept //seat to the left, the table size is known at compile time so this never divides
+		{
+			return player + 1 == static_cast<int>(configuration_t::num_players) ? 0 : player + 1;
+		}
+
+		constexpr void end_turn(bool deck_was_empty) //once the deck runs out, the game ends after the player who drew the last card plays again
+		{
+			if (deck_was_empty && last_player_to_play_ == player_turn_) last_player_has_played_ = true;
+
+			player_turn_ = next_player(player_turn_);
+		}
+
+		constexpr undo_record<Configuration> make_undo_record(int player) const
+		{
+			undo_record<Configuration> record;
+
+			record.hand_ = hands_[player];
+			record.hand_size_ = hand_sizes_[player];
+			record.player_turn_ = player_turn_;
+			record.num_available_hints_ = num_available_hints_;
+			record.num_mistakes_ = num_mistakes_;
+			record.next_card_to_draw_ = next_card_to_draw_;
+			record.last_player_to_play_ = last_player_to_play_;
+			record.last_player_has_played_ = last_player_has_played_;
+			record.hash_ = hash_;
+
+			return record;
+		}
+
+		constexpr void restore(const undo_record<Configuration>& record, int player) //puts back the drawn card, the hand of player and the counters
+		{
+			if (next_card_to_draw_ != record.next_card_to_draw_)
+			{
+				deck_.cards_[record.next_card_to_draw_.value()].move_to(location::draw_pile{});
+			}
+
+			hands_[player] = record.hand_;
+			hand_sizes_[player] = record.hand_size_;
+			player_turn_ = record.player_turn_;
+			num_available_hints_ = record.num_available_hints_;
+			num_mistakes_ = record.num_mistakes_;
+			next_card_to_draw_ = record.next_card_to_draw_;
+			last_player_to_play_ = record.last_player_to_play_;
+			last_player_has_played_ = record.last_player_has_played_;
+			hash_ = record.hash_;
+		}
+	};
+
+	template <typename Action> 
+	struct action
+	{
+		Action a_;
+
+		template <typename Configuration>
+		constexpr bool validate(const game_state<Configuration>& check) const
+		{
+			return a_.validate(check);
+		}
+
+		template <typename Configuration>
+		constexpr game_state<Configuration> perform (const game_state<Configuration>& source) const
+		{
+			if (!validate(source)) throw std::runtime_error("Action is not valid.");
+
+			return a_.perform(source);
+		}
+
+		template <typename Configuration>
+		constexpr undo_record<Configuration> apply(game_state<Configuration>& state) const
+		{
+			if (!validate(state)) throw std::runtime_error("Action is not valid.");
+
+			return a_.apply(state);
+		}
+
+		template <typename Configuration>
+		constexpr void undo(game_state<Configuration>& state, const undo_record<Configuration>& record) const
+		{
+			a_.undo(state, record);
+		}
+
+		template <typename Configuration>
+		std::ostream& display_action(std::ostream& stream, const game_state<Configuration>& state) const
+		{
+			return a_.display_action(stream, state);
+		}
+
+		template <typename Configuration>
+		std::ostream& display_hidden_action(std::ostream& stream, const game_state<Configuration>& state) const
+		{
+			return a_.display_hidden_action(stream, state);
+		}
+	};
+
+	template <typename Action>
+	action(Action&&)->action<Action>;
+
+	struct play
+	{ 
+		int card_;
+
+		template <typename Configuration>
+		constexpr bool is_playable(const game_state<Configuration>& source) const
+		{
+			const auto& this_card = source.deck_.cards_[card_];
+			return source.fireworks_[this_card.color_index()] == this_card.rank_index();
+		}
+
+		template <typename Configuration>
+		constexpr bool validate(const game_state<Configuration>& check) const
+		{
+			return check.deck_.cards_[card_].is_in_hand_of(check.player_turn_);
+		}
+
+		template <typename Configuration>
+		constexpr game_state<Configuration> perform(const game_state<Configuration>& source) const
+		{
+			auto target = source;
+			apply(target);
+			return target;
+		}
+
+		template <typename Configuration>
+		constexpr undo_record<Configuration> apply(game_state<Configuration>& state) const
+		{
+			auto record = state.make_undo_record(state.player_turn_);
+			auto& played_card = state.deck_.cards_[card_];
+			state.hash_ ^= zobrist<Configuration>::counters(state);
+			state.remove_from_hand(state.player_turn_, card_);
+
+			if (is_playable(state))
+			{
+				state.move_card(card_, location::in_play{});
+				++state.fireworks_[played_card.color_index()];
+
+				if (played_card.rank_index() == configuration::configuration_traits<Configuration>::num_ranks - 1
+					&& state.num_available_hints_ < Configuration::max_num_hints)
+				{
+					++state.num_available_hints_;
+				}
+			}
+			else
+			{
+				state.move_card(card_, location::discard_pile{});
+				++state.num_mistakes_;
+			}
+
+			state.draw_card();
+			state.end_turn(!record.next_card_to_draw_.has_value());
+			state.hash_ ^= zobrist<Configuration>::counters(state);
+			return record;
+		}
+
+		template <typename Configuration>
+		constexpr void undo(game_state<Configuration>& state, const undo_record<Configuration>& record) const
+		{
+			auto& played_card = state.deck_.cards_[card_];
+
+			if (played_card.is_in_play()) --state.fireworks_[played_card.color_index()];
+
+			played_card.move_to(location::hand{ record.player_turn_ });
+			state.restore(record, record.player_turn_);
+		}
+
+		template <typename Configuration>
+		std::ostream& display_action(std::ostream& stream, const game_state<Configuration>& state) const
+		{
+			stream << "playing ";
+			state.deck_.cards_[card_].get_card().display_card(stream) << (is_playable(state) ? " it worked!\n" : " it was a mistake.\n");
+			return stream;
+		}
+
+		template <typename Configuration>
+		std::ostream& display_hidden_action(std::ostream& stream, const game_state<Configuration>& state) const
+		{
+			stream << "playing card #" << card_ << '\n';
+			return stream;
+		}
+	};
+
+	template <typename Property> //card color or rank
+	struct hint 
+	{ 
+		int player_; 
+
+		template <typename Configuration>
+		constexpr bool validate(const game_state<Configuration>& check) const noexcept
+		{
+			const bool can_hint = check.num_available_hints_ > 0;
+			const bool can_hint_player = check.player_turn_ != player_; //cannot hint oneself
+			
+			if (!can_hint || !can_hint_player) return false;
+
+			const auto hand = check.hand_of(player_);
+
+			return std::any_of(hand.begin(), hand.end(), [&](std::uint8_t card_in_hand)
+				{
+					return has_property<Property>(check.deck_.cards_[card_in_hand]);
+				});
+		}
+
+		template <typename Configuration>
+		constexpr game_state<Configuration> perform(const game_state<Configuration>& source) const
+		{
+			auto target = source;
+			apply(target);
+			return target;
+		}
+
+		template <typename Configuration>
+		constexpr undo_record<Configuration> apply(game_state<Configuration>& state) const
+		{
+			auto record = state.make_undo_record(player_);
+			state.hash_ ^= zobrist<Configuration>::counters(state);
+			--state.num_available_hints_;
+
+			constexpr auto hinted_bit = property_bit<Property, Configuration>();
+
+			for (size_t slot = 0; slot < record.hand_size_; ++slot)
+			{
+				const auto& card_in_deck = state.deck_.cards_[record.hand_[slot]];
+				record.knowledge_[slot] = card_in_deck.knowledge_;
+
+				auto known = card_in_deck.knowledge_;
+				auto& hinted = is_property_a_color_v<Property, Configuration> ? known.hinted_colors_ : known.hinted_ranks_;
+
+				if (has_property<Property>(card_in_deck))
+				{
+					hinted = hinted_bit;
+					known.clued_ = true;
+				}
+				else
+				{
+					hinted &= static_cast<std::uint8_t>(~hinted_bit);
+				}
+
+				state.set_knowledge(record.hand_[slot], known);
+			}
+
+			state.end_turn(!record.next_card_to_draw_.has_value());
+			state.hash_ ^= zobrist<Configuration>::counters(state);
+			return record;
+		}
+
+		template <typename Configuration>
+		constexpr void undo(game_state<Configuration>& state, const undo_record<Configuration>& record) const
+		{
+			for (size_t slot = 0; slot < record.hand_size_; ++slot)
+			{
+				state.deck_.cards_[record.hand_[slot]].knowledge_ = record.knowledge_[slot];
+			}
+
+			state.restore(record, player_);
+		}
+
+		template <typename Configuration>
+		std::ostream& display_action(std::ostream& stream, const game_state<Configuration>& state) const
+		{
+			if constexpr (is_property_a_color_v<Property, Configuration> != is_property_a_rank_v<Property, Configuration>)
+			{
+				stream << "hinting about all of the ";
+				
+				if constexpr (is_property_a_color_v<Property, Configuration>)
+				{
+					stream << Property::display_color() << termcolor::bold << Property::display_name() << termcolor::reset << " cards.\n";
+				}
+				else
+				{
+					stream << termcolor::magenta << termcolor::bold << Property::display_rank() << termcolor::reset << "s in hand.\n";
+				}
+			}
+			else
+			{
+				static_assert(dependent_false<Configuration>::value, "Hint for this property is ill-formed. Hint can neither be for both rank or color (and must be at least one).");
+			}
+
+			return stream;
+		}
+
+		template <typename Configuration>
+		std::ostream& display_hidden_action(std::ostream& stream, const game_state<Configuration>& state) const
+		{
+			return display_action(stream, state);
+		}
+	};
+	
+	struct discard
+	{
+		int card_; 
+
+		template <typename Configuration>
+		constexpr bool validate(const game_state<Configuration>& check) const
+		{
+			return check.deck_.cards_[card_].is_in_hand_of(check.player_turn_);
+		}
+
+		template <typename Configuration>
+		constexpr game_state<Configuration> perform(const game_state<Configuration>& source) const
+		{
+			auto target = source;
+			apply(target);
+			return target;
+		}
+
+		template <typename Configuration>
+		constexpr undo_record<Configuration> apply(game_state<Configuration>& state) const
+		{
+			auto record = state.make_undo_record(state.player_turn_);
+			state.hash_ ^= zobrist<Configuration>::counters(state);
+
+			state.remove_from_hand(state.player_turn_, card_);
+			state.move_card(card_, location::discard_pile{});
+				
+			if (state.num_available_hints_ < Configuration::max_num_hints)
+			{
+				++state.num_available_hints_;
+			}
+
+			state.draw_card();
+			state.end_turn(!record.next_card_to_draw_.has_value());
+			state.hash_ ^= zobrist<Configuration>::counters(state);
+			return record;
+		}
+
+		template <typename Configuration>
+		constexpr void undo(game_state<Configuration>& state, const undo_record<Configuration>& record) const
+		{
+			state.deck_.cards_[card_].move_to(location::hand{ record.player_turn_ });
+			state.restore(record, record.player_turn_);
+		}
+
+		template <typename Configuration>
+		std::ostream& display_action(std::ostream& stream, const game_state<Configuration>& state) const
+		{
+			stream << "discarding ";
+			state.deck_.cards_[card_].get_card().display_card(stream) << '\n';
+			return stream;
+		}
+
+		template <typename Configuration>
+		std::ostream& display_hidden_action(std::ostream& stream, const game_state<Configuration>& state) const
+		{
+			stream << "discarding card #" << card_ << '\n';
+			return stream;
+		}
+	};
+
+	template <typename T, size_t Capacity>
+	class inline_vector //fixed capacity vector that never allocates
+	{
+	public:
+
+		template <typename... TArgs>
+		constexpr T& emplace_back(TArgs&&... args)
+		{
+			return elements_[size_++] = T(std::forward<TArgs>(args)...);
+		}
+
+		constexpr void clear() noexcept { size_ = 0; }
+		constexpr size_t size() const noexcept { return size_; }
+		constexpr bool empty() const noexcept { return size_ == 0; }
+		static constexpr size_t capacity() noexcept { return Capacity; }
+
+		constexpr T& operator[](size_t i) noexcept { return elements_[i]; }
+		constexpr const T& operator[](size_t i) const noexcept { return elements_[i]; }
+
+		constexpr T* begin() noexcept { return elements_.data(); }
+		constexpr T* end() noexcept { return elements_.data() + size_; }
+		constexpr const T* begin() const noexcept { return elements_.data(); }
+		constexpr const T* end() const noexcept { return elements_.data() + size_; }
+
+	private:
+
+		std::array<T, Capacity> elements_{};
+		size_t size_ = 0;
+	};
+
+	template <typename Configuration, typename Visitor>
+	constexpr void for_each_possible_action(const game_state<Configuration>& state, Visitor&& visit)
+	{
+		for (const int card_in_hand : state.hand_of(state.player_turn_))
+		{
+			visit(action{ play{ card_in_hand } });
+			visit(action{ discard{ card_in_hand } });
+		}
+
+		if (state.num_available_hints_ <= 0) return;
+
+		for (int partner = game_state<Configuration>::next_player(state.player_turn_); partner != state.player_turn_; partner = game_state<Configuration>::next_player(partner))
+		{
+			std::uint8_t possible_colors = 0;
+			std::uint8_t possible_ranks = 0;
+
+			for (const auto card_in_hand : state.hand_of(partner))
+			{
+				const auto& card_in_deck = state.deck_.cards_[card_in_hand];
+				possible_colors |= static_cast<std::uint8_t>(1u << card_in_deck.color_index());
+				possible_ranks |= static_cast<std::uint8_t>(1u << card_in_deck.rank_index());
+			}
+
+			std::apply([&] <typename... Colors> (const Colors&...)
+			{
+				((possible_colors & property_bit<Colors, Configuration>() ? static_cast<void>(visit(hint<Colors> {partner})) : static_cast<void>(0)), ...);
+			}, typename Configuration::template colors<std::tuple>{});
+
+			std::apply([&] <typename... Ranks> (const Ranks&...)
+			{
+				((possible_ranks & property_bit<Ranks, Configuration>() ? static_cast<void>(visit(hint<Ranks> {partner})) : static_cast<void>(0)), ...);
+			}, typename Configuration::template ranks<std::tuple>{});
+		}
+	}
+
+	template <typename Configuration>
+	using possible_actions_t = inline_vector<typename Configuration::template actions<std::variant>, configuration::configuration_traits<Configuration>::max_num_actions>;
+
+	template <typename Configuration>
+	constexpr possible_actions_t<Configuration> find_all_possible_actions(const game_state<Configuration>& state)
+	{
+		possible_actions_t<Configuration> possible_actions;
+
+		for_each_possible_action(state, [&](const auto& possible_action)
+			{
+				possible_actions.emplace_back(possible_action);
+			});
+
+		return possible_actions;
+	}
+
+	template <typename Configuration>
+	struct action_code //every action as one byte that needs no state to decode, and can be carried out without going back to the variant
+	{
+		//playing card n is n, discarding it is deck_size + n, and hints follow at 2 * deck_size + player * num_properties + property, colors before ranks
+
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+		using actions_t = typename Configuration::template actions<std::variant>;
+
+		static constexpr size_t num_properties = configuration_t::num_colors + configuration_t::num_ranks;
+		static constexpr size_t num_codes = 2 * configuration_t::deck_size + configuration_t::num_players * num_properties;
+
+		static_assert(num_codes <= 256, "Action codes must fit in a byte.");
+
+		static constexpr std::uint8_t encode(const action<play>& playing) noexcept
+		{
+			return static_cast<std::uint8_t>(playing.a_.card_);
+		}
+
+		static constexpr std::uint8_t encode(const action<discard>& discarding) noexcept
+		{
+			return static_cast<std::uint8_t>(configuration_t::deck_size + discarding.a_.card_);
+		}
+
+		template <typename Property>
+		static constexpr std::uint8_t encode(const hint<Property>& hinting) noexcept
+		{
+			if constexpr (is_property_a_color_v<Property, Configuration>)
+			{
+				return static_cast<std::uint8_t>(2 * configuration_t::deck_size + hinting.player_ * num_properties + configuration_t::template color_index<Property>);
+			}
+			else
+			{
+				return static_cast<std::uint8_t>(2 * configuration_t::deck_size + hinting.player_ * num_properties + configuration_t::num_colors + configuration_t::template rank_index<Property>);
+			}
+		}
+
+		static constexpr std::uint8_t encode(const actions_t& any_action) noexcept
+		{
+			return std::visit([](const auto& a) { return encode(a); }, any_action);
+		}
+
+		static constexpr actions_t decode(std::uint8_t code)
+		{
+			return dispatch_[code].decode_(dispatch_[code].argument_);
+		}
+
+		//each of these does what the decoded action's member of the same name does, through one indirect call
+
+		static constexpr bool validate(const game_state<Configuration>& state, std::uint8_t code)
+		{
+			return dispatch_[code].validate_(state, dispatch_[code].argument_);
+		}
+
+		static constexpr undo_record<Configuration> apply(game_state<Configuration>& state, std::uint8_t code)
+		{
+			return dispatch_[code].apply_(state, dispatch_[code].argument_);
+		}
+
+		static constexpr void undo(game_state<Configuration>& state, std::uint8_t code, const undo_record<Configuration>& record)
+		{
+			dispatch_[code].undo_(state, record, dispatch_[code].argument_);
+		}
+
+		static constexpr game_state<Configuration> perform(const game_state<Configuration>& source, std::uint8_t code)
+		{
+			auto target = source;
+			apply(target, code);
+			return target;
+		}
+
+	private:
+
+		struct entry
+		{
+			actions_t (*decode_)(int);
+			bool (*validate_)(const game_state<Configuration>&, int);
+			undo_record<Configuration> (*apply_)(game_state<Configuration>&, int);
+			void (*undo_)(game_state<Configuration>&, const undo_record<Configuration>&, int);
+			int argument_; //the card played or discarded, or the player hinted
+		};
+
+		template <typename Action>
+		static constexpr Action make(int argument) noexcept
+		{
+			if constexpr (std::is_same_v<Action, action<play>>) return action{ play{ argument } };
+			else if constexpr (std::is_same_v<Action, action<discard>>) return action{ discard{ argument } };
+			else return Action{ argument };
+		}
+
+		template <typename Action>
+		static constexpr entry entry_for(int argument) noexcept
+		{
+			return {
+				[](int a) -> actions_t { return make<Action>(a); },
+				[](const game_state<Configuration>& state, int a) { return make<Action>(a).validate(state); },
+				[](game_state<Configuration>& state, int a) { return make<Action>(a).apply(state); },
+				[](game_state<Configuration>& state, const undo_record<Configuration>& record, int a) { make<Action>(a).undo(state, record); },
+				argument };
+		}
+
+		static constexpr auto dispatch_ = []()
+		{
+			std::array<entry, num_codes> table{};
+
+			for (int card = 0; card < static_cast<int>(configuration_t::deck_size); ++card)
+			{
+				table[card] = entry_for<action<play>>(card);
+				table[configuration_t::deck_size + card] = entry_for<action<discard>>(card);
+			}
+
+			std::apply([&] <typename... Properties> (const Properties&...)
+			{
+				for (int player = 0; player < static_cast<int>(configuration_t::num_players); ++player)
+				{
+					size_t property = 2 * configuration_t::deck_size + player * num_properties;
+					((table[property++] = entry_for<hint<Properties>>(player)), ...);
+				}
+			}, std::tuple_cat(typename Configuration::template colors<std::tuple>{}, typename Configuration::template ranks<std::tuple>{}));
+
+			return table;
+		}();
+	};
+
+	template <typename Configuration>
+	class belief //what each player can infer about the cards in their own hand from the hints they were given and the cards they can see
+	{
+	public:
+
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+		using identity_mask_t = std::uint32_t; //bit n is set for the card identity n, color index * num_ranks + rank index
+
+		static_assert(configuration_t::max_score < 32, "Card identities are stored as a 32 bit mask.");
+
+		void reset(const game_state<Configuration>& state)
+		{
+			std::array<std::array<std::uint8_t, configuration_t::max_score>, configuration_t::num_players> unseen;
+			unseen.fill(frequencies_);
+			discarded_ = {};
+
+			for (const auto& card_in_deck : state.deck_.cards_)
+			{
+				if (card_in_deck.is_in_draw_pile()) continue;
+
+				for (int player = 0; player < static_cast<int>(configuration_t::num_players); ++player)
+				{
+					if (!card_in_deck.is_in_hand_of(player)) --unseen[player][card_in_deck.identity_];
+				}
+
+				if (card_in_deck.is_in_discard_pile()) ++discarded_[card_in_deck.identity_];
+			}
+
+			for (size_t player = 0; player < configuration_t::num_players; ++player)
+			{
+				for (size_t identity = 0; identity < configuration_t::max_score; ++identity) set_unseen(static_cast<int>(player), identity, unseen[player][identity]);
+			}
+		}
+
+		template <typename Action>
+		void observe(const game_state<Configuration>& state, const Action& taken) //state is the one the action is taken from, hints only change knowledge<>
+		{
+			if constexpr (std::is_same_v<Action, action<play>> || std::is_same_v<Action, action<discard>>)
+			{
+				const auto& card_in_deck = state.deck_.cards_[taken.a_.card_];
+
+				see(state.player_turn_, card_in_deck.identity_);
+
+				if constexpr (std::is_same_v<Action, action<play>>)
+				{
+					if (!taken.a_.is_playable(state)) ++discarded_[card_in_deck.identity_];
+				}
+				else
+				{
+					++discarded_[card_in_deck.identity_];
+				}
+
+				if (state.next_card_to_draw_.has_value())
+				{
+					const auto drawn_identity = state.deck_.cards_[state.next_card_to_draw_.value()].identity_;
+
+					for (int player = 0; player < static_cast<int>(configuration_t::num_players); ++player)
+					{
+						if (player != state.player_turn_) see(player, drawn_identity);
+					}
+				}
+			}
+		}
+
+		static constexpr identity_mask_t possible(const knowledge<Configuration>& known) noexcept //identities the hints allow
+		{
+			return color_masks_[known.hinted_colors_] & rank_masks_[known.hinted_ranks_];
+		}
+
+		static constexpr identity_mask_t playable(const game_state<Configuration>& state) noexcept
+		{
+			identity_mask_t playable_identities = 0;
+
+			for (size_t color = 0; color < configuration_t::num_colors; ++color)
+			{
+				if (state.fireworks_[color] < configuration_t::num_ranks) playable_identities |= identity_mask_t{ 1 } << (color * configuration_t::num_ranks + state.fireworks_[color]);
+			}
+
+			return playable_identities;
+		}
+
+		identity_mask_t useless(const game_state<Configuration>& state) const noexcept //already played, or out of reach because every copy of a lower rank was discarded
+		{
+			identity_mask_t useless_identities = 0;
+
+			for (size_t color = 0; color < configuration_t::num_colors; ++color)
+			{
+				const auto first = color * configuration_t::num_ranks;
+				auto reachable = first + state.fireworks_[color];
+
+				while (reachable < first + configuration_t::num_ranks && discarded_[reachable] < frequencies_[reachable]) ++reachable;
+
+				const auto still_needed = ((identity_mask_t{ 1 } << reachable) - 1) ^ ((identity_mask_t{ 1 } << (first + state.fireworks_[color])) - 1);
+				useless_identities |= color_masks_[1u << color] & ~still_needed;
+			}
+
+			return useless_identities;
+		}
+
+		identity_mask_t critical(const game_state<Configuration>& state) const noexcept //still needed, and the last copy that has not been discarded
+		{
+			identity_mask_t critical_identities = 0;
+
+			for (size_t identity = 0; identity < configuration_t::max_score; ++identity)
+			{
+				if (discarded_[identity] + 1 == frequencies_[identity]) critical_identities |= identity_mask_t{ 1 } << identity;
+			}
+
+			return critical_identities & ~useless(state);
+		}
+
+		int unseen(int player, size_t identity) const noexcept //copies player cannot see, in the draw pile or in their own hand
+		{
+			int copies = 0;
+			for (size_t bit = 0; bit < count_bits; ++bit) copies |= static_cast<int>((unseen_bits_[player][bit] >> identity) & 1u) << bit;
+			return copies;
+		}
+
+		identity_mask_t candidates(int player, const knowledge<Configuration>& known) const noexcept //identities the hints allow that player has not seen every copy of
+		{
+			identity_mask_t any_unseen = 0;
+			for (const auto plane : unseen_bits_[player]) any_unseen |= plane;
+			return possible(known) & any_unseen;
+		}
+
+		int weight(int player, identity_mask_t identities) const noexcept
+		{
+			int total = 0;
+			for (size_t bit = 0; bit < count_bits; ++bit) total += std::popcount(identities & unseen_bits_[player][bit]) << bit;
+			return total;
+		}
+
+		double probability(const game_state<Configuration>& state, int card, identity_mask_t identities) const noexcept //that a card in hand is one of identities, for the player holding it
+		{
+			const auto& card_in_deck = state.deck_.cards_[card];
+			const int holder = card_in_deck.location_ >> card_state<Configuration>::location_bits;
+			const auto candidates = possible(card_in_deck.knowledge_);
+
+			const int total = weight(holder, candidates);
+			return total > 0 ? static_cast<double>(weight(holder, candidates & identities)) / total : 0.0;
+		}
+
+		std::array<double, configuration_t::max_score> distribution(const game_state<Configuration>& state, int card) const noexcept
+		{
+			std::array<double, configuration_t::max_score> chances{};
+
+			const auto& card_in_deck = state.deck_.cards_[card];
+			const int holder = card_in_deck.location_ >> card_state<Configuration>::location_bits;
+			const auto candidates = possible(card_in_deck.knowledge_);
+			const int total = weight(holder, candidates);
+
+			for (auto identities = candidates; identities != 0 && total > 0; identities &= identities - 1)
+			{
+				const auto identity = std::countr_zero(identities);
+				chances[identity] = static_cast<double>(unseen(holder, identity)) / total;
+			}
+
+			return chances;
+		}
+
+	private:
+
+		void see(int player, std::uint8_t identity) noexcept
+		{
+			set_unseen(player, identity, unseen(player, identity) - 1);
+		}
+
+		void set_unseen(int player, size_t identity, int copies) noexcept
+		{
+			const auto identity_bit = identity_mask_t{ 1 } << identity;
+
+			for (size_t bit = 0; bit < count_bits; ++bit)
+			{
+				unseen_bits_[player][bit] = (unseen_bits_[player][bit] & ~identity_bit) | (((copies >> bit) & 1) ? identity_bit : 0);
+			}
+		}
+
+		static constexpr std::array<std::uint8_t, configuration_t::max_score> frequencies_ = []()
+		{
+			std::array<std::uint8_t, configuration_t::max_score> copies{};
+
+			std::apply([&] <typename... Colors, typename... Ranks, size_t... Freqs> (const card_frequency<Colors, Ranks, Freqs>&...)
+			{
+				((copies[card_state<Configuration>::template identity_of<Colors, Ranks>()] += static_cast<std::uint8_t>(Freqs)), ...);
+			}, typename configuration_t::card_frequencies{});
+
+			return copies;
+		}();
+
+		static constexpr auto color_masks_ = []() //every identity of the colors in a hinted_colors_ mask
+		{
+			std::array<identity_mask_t, 256> masks{};
+
+			for (size_t colors = 0; colors < masks.size(); ++colors)
+			{
+				for (size_t color = 0; color < configuration_t::num_colors; ++color)
+				{
+					if ((colors >> color) & 1u) masks[colors] |= ((identity_mask_t{ 1 } << configuration_t::num_ranks) - 1) << (color * configuration_t::num_ranks);
+				}
+			}
+
+			return masks;
+		}();
+
+		static constexpr auto rank_masks_ = []() //every identity of the ranks in a hinted_ranks_ mask
+		{
+			std::array<identity_mask_t, 256> masks{};
+
+			for (size_t ranks = 0; ranks < masks.size(); ++ranks)
+			{
+				for (size_t color = 0; color < configuration_t::num_colors; ++color)
+				{
+					masks[ranks] |= static_cast<identity_mask_t>(ranks & ((1u << configuration_t::num_ranks) - 1)) << (color * configuration_t::num_ranks);
+				}
+			}
+
+			return masks;
+		}();
+
+		static constexpr size_t count_bits = std::bit_width(*std::max_element(frequencies_.begin(), frequencies_.end()));
+
+		std::array<std::array<identity_mask_t, count_bits>, configuration_t::num_players> unseen_bits_{}; //bit planes of the unseen count of every identity, so weights are popcounts
+		std::array<std::uint8_t, configuration_t::max_score> discarded_{};
+	};
+
+	template <typename Configuration>
+	class deal_sampler //the cards a player cannot see, their hand and the draw pile, redealt uniformly among the deals that agree with the hints in their hand
+	{
+		//with identities taken in order, ways_[k][filled] counts the ways to deal the copies of identities below k to exactly the hand slots in filled.
+		//a sample walks back down the identities, picking the slots each one takes with odds in proportion to the ways left for the rest,
+		//which a single number in [0, num_hands()) decides. the draw pile is then a shuffle of the copies left over
+	public:
+
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+		using slots_t = std::uint32_t; //bit n for hand slot n
+
+		static_assert(configuration_t::hand_size < 32, "Hand slots are stored as a 32 bit mask.");
+
+		deal_sampler(const game_state<Configuration>& state, int player)
+		{
+			const auto hand = state.hand_of(player);
+			const auto first_in_draw_pile = state.next_card_to_draw_.value_or(static_cast<int>(configuration_t::deck_size));
+
+			num_slots_ = hand.size();
+			num_hidden_ = num_slots_;
+			std::copy(hand.begin(), hand.end(), positions_.begin());
+			for (int position = first_in_draw_pile; position < static_cast<int>(configuration_t::deck_size); ++position) positions_[num_hidden_++] = static_cast<std::uint8_t>(position);
+
+			for (size_t i = 0; i < num_hidden_; ++i) ++copies_[state.deck_.cards_[positions_[i]].identity_];
+
+			for (size_t identity = 0; identity < configuration_t::max_score; ++identity)
+			{
+				arrangements_[identity][0] = 1; //ordered picks of n copies
+				for (size_t n = 1; n <= configuration_t::hand_size; ++n) arrangements_[identity][n] = arrangements_[identity][n - 1] * (copies_[identity] >= n ? copies_[identity] - n + 1 : 0);
+			}
+
+			for (size_t slot = 0; slot < num_slots_; ++slot)
+			{
+				const auto& known = state.deck_.cards_[hand[slot]].knowledge_;
+
+				for (size_t identity = 0; identity < configuration_t::max_score; ++identity)
+				{
+					if (known.is_color_possible(identity / configuration_t::num_ranks) && known.is_rank_possible(identity % configuration_t::num_ranks)) allowed_slots_[identity] |= slots_t{ 1 } << slot;
+				}
+			}
+
+			all_slots_ = static_cast<slots_t>((1u << num_slots_) - 1);
+			ways_[0][0] = 1;
+
+			for (size_t identity = 0; identity < configuration_t::max_score; ++identity)
+			{
+				if ((allowed_slots_[identity] & all_slots_) == 0 || copies_[identity] == 0) //can only fill no slot
+				{
+					ways_[identity + 1] = ways_[identity];
+					continue;
+				}
+
+				for (slots_t filled = 0; filled <= all_slots_; ++filled)
+				{
+					if (ways_[identity][filled] == 0) continue;
+
+					const auto open = allowed_slots_[identity] & all_slots_ & ~filled;
+					for (slots_t taken = open; ; taken = (taken - 1) & open) //every subset of open, the empty one last
+					{
+						ways_[identity + 1][filled | taken] += ways_[identity][filled] * arrangements_[identity][std::popcount(taken)];
+						if (taken == 0) break;
+					}
+				}
+			}
+		}
+
+		size_t num_hidden() const //identities in a deal, the hand slots first and then the draw pile from the next card drawn
+		{
+			return num_hidden_;
+		}
+
+		std::span<const std::uint8_t> positions() const //where in the deck each identity of a deal goes
+		{
+			return { positions_.data(), num_hidden_ };
+		}
+
+		std::uint64_t num_hands() const //hands that agree with the hints, copies told apart. never 0 for a state reached by play, the real hand agrees
+		{
+			return ways_[configuration_t::max_score][all_slots_];
+		}
+
+		template <typename Gen>
+		void sample(Gen& gen, std::span<std::uint8_t> identities) const //one deal, num_hidden() identities
+		{
+			auto left = copies_;
+			auto pick = std::uniform_int_distribution<std::uint64_t>(0, num_hands() - 1)(gen);
+			auto unfilled = all_slots_;
+
+			for (size_t identity = configuration_t::max_score; unfilled != 0 && identity-- > 0;)
+			{
+				const auto open = allowed_slots_[identity] & unfilled;
+				if (open == 0) continue;
+
+				const auto none_taken = ways_[identity][unfilled]; //by far the likeliest, so tried first. pick keeps its value
+				if (pick < none_taken) continue;
+				pick -= none_taken;
+
+				for (slots_t taken = open; taken != 0; taken = (taken - 1) & open)
+				{
+					const auto per_way = arrangements_[identity][std::popcount(taken)];
+					const auto block = ways_[identity][unfilled & ~taken] * per_way;
+
+					if (pick < block)
+					{
+						pick /= per_way;
+						left[identity] -= static_cast<std::uint8_t>(std::popcount(taken));
+						unfilled &= ~taken;
+						for (auto slots = taken; slots != 0; slots &= slots - 1) identities[std::countr_zero(slots)] = static_cast<std::uint8_t>(identity);
+						break;
+					}
+
+					pick -= block;
+				}
+			}
+
+			auto next = identities.begin() + num_slots_;
+			for (size_t identity = 0; identity < configuration_t::max_score; ++identity) next = std::fill_n(next, left[identity], static_cast<std::uint8_t>(identity));
+
+			std::shuffle(identities.begin() + num_slots_, identities.begin() + num_hidden_, gen);
+		}
+
+		template <typename Gen>
+		void sample_many(Gen& gen, std::span<std::uint8_t> deals) const //deals.size() / num_hidden() deals back to back
+		{
+			for (size_t first = 0; first + num_hidden_ <= deals.size(); first += num_hidden_) sample(gen, deals.subspan(first, num_hidden_));
+		}
+
+		game_state<Configuration> redeal(const game_state<Configuration>& state, std::span<const std::uint8_t> identities) const //state the sampler was made from, with a sampled deal in place
+		{
+			auto redealt = state;
+			for (size_t i = 0; i < num_hidden_; ++i) redealt.deck_.cards_[positions_[i]].identity_ = identities[i];
+			return redealt; //zobrist hashes leave identities out, so hash_ still holds
+		}
+
+		template <typename Gen>
+		game_state<Configuration> determinize(const game_state<Configuration>& state, Gen& gen) const
+		{
+			std::array<std::uint8_t, configuration_t::deck_size> identities;
+			sample(gen, std::span<std::uint8_t>(identities.data(), num_hidden_));
+			return redeal(state, identities);
+		}
+
+	private:
+
+		size_t num_slots_ = 0;
+		size_t num_hidden_ = 0;
+		slots_t all_slots_ = 0;
+		std::array<std::uint8_t, configuration_t::deck_size> positions_{};
+		std::array<std::uint8_t, configuration_t::max_score> copies_{};
+		std::array<slots_t, configuration_t::max_score> allowed_slots_{};
+		std::array<std::array<std::uint64_t, configuration_t::hand_size + 1>, configuration_t::max_score> arrangements_{};
+		std::array<std::array<std::uint64_t, std::size_t{ 1 } << configuration_t::hand_size>, configuration_t::max_score + 1> ways_{};
+	};
+
+	template <typename Configuration>
+	struct observed_action //what every player saw of an action, recorded from the state it was taken in
+	{
+		using actions_t = typename Configuration::template actions<std::variant>;
+
+		static constexpr std::uint8_t none = 0xFF;
+
+		std::uint8_t actor_ = none;
+		std::uint8_t code_ = none; //action_code of the action
+		std::uint8_t slot_ = none; //hand position of the played or discarded card
+		std::uint8_t identity_ = none; //the played or discarded card, which is revealed by doing so
+		bool scored_ = false;
+
+		static constexpr observed_action of(const game_state<Configuration>& state, const actions_t& taken)
+		{
+			observed_action seen;
+			seen.actor_ = static_cast<std::uint8_t>(state.player_turn_);
+			seen.code_ = action_code<Configuration>::encode(taken);
+
+			std::visit([&] <typename Action> (const Action& a)
+			{
+				if constexpr (std::is_same_v<Action, action<play>> || std::is_same_v<Action, action<discard>>)
+				{
+					const auto hand = state.hand_of(state.player_turn_);
+
+					seen.slot_ = static_cast<std::uint8_t>(std::find(hand.begin(), hand.end(), static_cast<std::uint8_t>(a.a_.card_)) - hand.begin());
+					seen.identity_ = state.deck_.cards_[a.a_.card_].identity_;
+
+					if constexpr (std::is_same_v<Action, action<play>>) seen.scored_ = a.a_.is_playable(state);
+				}
+			}, taken);
+
+			return seen;
+		}
+	};
+
+	template <typename Configuration>
+	class observation_encoder //a game_state as one player sees it, as a fixed layout of bits for learning code to consume
+	{
+	public:
+
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+		using word_t = std::uint64_t;
+
+		//every field is a run of bits, counts are thermometer coded and choices one hot. partners and the actor of the last action are seats counted from the observer.
+		static constexpr size_t num_properties = configuration_t::num_colors + configuration_t::num_ranks;
+		static constexpr size_t own_card_bits = 1 + num_properties; //present, then the hinted_colors_ and hinted_ranks_ masks
+		static constexpr size_t partner_card_bits = 1 + configuration_t::max_score + num_properties; //present, identity, then what the partner knows of it
+		static constexpr size_t num_dealt = configuration_t::num_players * configuration_t::hand_size;
+
+		static constexpr size_t own_hand_offset = 0;
+		static constexpr size_t partner_hands_offset = own_hand_offset + configuration_t::hand_size * own_card_bits;
+		static constexpr size_t fireworks_offset = partner_hands_offset + (configuration_t::num_players - 1) * configuration_t::hand_size * partner_card_bits;
+		static constexpr size_t discards_offset = fireworks_offset + configuration_t::max_score; //one bit per copy of each identity
+		static constexpr size_t draw_pile_offset = discards_offset + configuration_t::deck_size;
+		static constexpr size_t hints_offset = draw_pile_offset + configuration_t::deck_size - num_dealt;
+		static constexpr size_t mistakes_offset = hints_offset + Configuration::max_num_hints;
+		static constexpr size_t last_actor_offset = mistakes_offset + Configuration::max_num_mistakes;
+		static constexpr size_t last_kind_offset = last_actor_offset + configuration_t::num_players; //play, discard, color hint, rank hint
+		static constexpr size_t last_target_offset = last_kind_offset + 4; //hinted seat counted from the actor
+		static constexpr size_t last_property_offset = last_target_offset + configuration_t::num_players - 1;
+		static constexpr size_t last_slot_offset = last_property_offset + num_properties;
+		static constexpr size_t last_identity_offset = last_slot_offset + configuration_t::hand_size;
+		static constexpr size_t last_scored_offset = last_identity_offset + configuration_t::max_score;
+
+		static constexpr size_t size = last_scored_offset + 1;
+		static constexpr size_t num_words = (size + 63) / 64;
+
+		static_assert(partner_card_bits <= 64 && configuration_t::deck_size - num_dealt <= 64, "Each field is written with a single 64 bit store.");
+
+		static void encode(const game_state<Configuration>& state, int observer, const observed_action<Configuration>& last, std::span<word_t, num_words> out) noexcept
+		{
+			std::fill(out.begin(), out.end(), word_t{ 0 });
+
+			for (size_t slot = 0; slot < state.hand_sizes_[observer]; ++slot)
+			{
+				put(out, own_hand_offset + slot * own_card_bits, 1u | known_bits(state.deck_.cards_[state.hands_[observer][slot]].knowledge_) << 1, own_card_bits);
+			}
+
+			auto partner = game_state<Configuration>::next_player(observer);
+			for (size_t seat = 0; seat + 1 < configuration_t::num_players; ++seat, partner = game_state<Configuration>::next_player(partner))
+			{
+				const auto hand = state.hand_of(partner);
+
+				for (size_t slot = 0; slot < hand.size(); ++slot)
+				{
+					const auto& card_in_deck = state.deck_.cards_[hand[slot]];
+					const auto card_bits = 1u | word_t{ 1 } << (1 + card_in_deck.identity_) | known_bits(card_in_deck.knowledge_) << (1 + configuration_t::max_score);
+
+					put(out, partner_hands_offset + (seat * configuration_t::hand_size + slot) * partner_card_bits, card_bits, partner_card_bits);
+				}
+			}
+
+			for (size_t color = 0; color < configuration_t::num_colors; ++color)
+			{
+				put(out, fireworks_offset + color * configuration_t::num_ranks, thermometer(state.fireworks_[color]), configuration_t::num_ranks);
+			}
+
+			std::array<std::uint8_t, configuration_t::max_score> discarded{};
+			for (const auto& card_in_deck : state.deck_.cards_)
+			{
+				if (card_in_deck.is_in_discard_pile()) set(out, discards_offset + first_copy_[card_in_deck.identity_] + discarded[card_in_deck.identity_]++);
+			}
+
+			const auto left_to_draw = state.next_card_to_draw_.has_value() ? configuration_t::deck_size - state.next_card_to_draw_.value() : 0;
+			put(out, draw_pile_offset, thermometer(left_to_draw), configuration_t::deck_size - num_dealt);
+			put(out, hints_offset, thermometer(state.num_available_hints_), Configuration::max_num_hints);
+			put(out, mistakes_offset, thermometer(state.num_mistakes_), Configuration::max_num_mistakes);
+
+			if (last.actor_ == observed_action<Configuration>::none) return;
+
+			set(out, last_actor_offset + seats_after(observer, last.actor_));
+
+			if (last.code_ < 2 * configuration_t::deck_size)
+			{
+				set(out, last_kind_offset + (last.code_ < configuration_t::deck_size ? 0 : 1));
+				set(out, last_slot_offset + last.slot_);
+				set(out, last_identity_offset + last.identity_);
+				if (last.scored_) set(out, last_scored_offset);
+			}
+			else
+			{
+				const auto hint_code = last.code_ - 2 * configuration_t::deck_size;
+				const auto property = hint_code % num_properties;
+
+				set(out, last_kind_offset + (property < configuration_t::num_colors ? 2 : 3));
+				set(out, last_target_offset + seats_after(last.actor_, static_cast<int>(hint_code / num_properties)) - 1);
+				set(out, last_property_offset + property);
+			}
+		}
+
+		static void encode(const game_state<Configuration>& state, int observer, const observed_action<Configuration>& last, std::span<float, size> out) noexcept
+		{
+			std::array<word_t, num_words> packed;
+			encode(state, observer, last, packed);
+			expand(packed, out.data());
+		}
+
+		//one observation per game, written back to back into out, which must hold states.size() of them
+		static void encode(std::span<const game_state<Configuration>> states, std::span<const int> observers, std::span<const observed_action<Configuration>> last, std::span<word_t> out) noexcept
+		{
+			for (size_t i = 0; i < states.size(); ++i)
+			{
+				encode(states[i], observers[i], last[i], std::span<word_t, num_words>(out.data() + i * num_words, num_words));
+			}
+		}
+
+		static void encode(std::span<const game_state<Configuration>> states, std::span<const int> observers, std::span<const observed_action<Configuration>> last, std::span<float> out) noexcept
+		{
+			for (size_t i = 0; i < states.size(); ++i)
+			{
+				encode(states[i], observers[i], last[i], std::span<float, size>(out.data() + i * size, size));
+			}
+		}
+
+	private:
+
+		static constexpr word_t thermometer(size_t count) noexcept
+		{
+			return (word_t{ 1 } << count) - 1;
+		}
+
+		static constexpr word_t known_bits(const knowledge<Configuration>& known) noexcept
+		{
+			return known.hinted_colors_ | word_t{ known.hinted_ranks_ } << configuration_t::num_colors;
+		}
+
+		static constexpr int seats_after(int from, int seat) noexcept
+		{
+			return seat >= from ? seat - from : seat + static_cast<int>(configuration_t::num_players) - from;
+		}
+
+		static void set(std::span<word_t, num_words> out, size_t bit) noexcept
+		{
+			out[bit / 64] |= word_t{ 1 } << (bit % 64);
+		}
+
+		static void put(std::span<word_t, num_words> out, size_t offset, word_t bits, size_t width) noexcept //bits must fit in width, which is at most 64
+		{
+			const auto shift = offset % 64;
+
+			out[offset / 64] |= bits << shift;
+			if (shift + width > 64) out[offset / 64 + 1] |= bits >> (64 - shift);
+		}
+
+		static void expand(std::span<const word_t, num_words> packed, float* out) noexcept //a byte of bits at a time, as a copy of eight floats from a table
+		{
+			for (size_t byte = 0; byte < size / 8; ++byte)
+			{
+				const auto& floats = byte_floats_[(packed[byte / 8] >> (8 * (byte % 8))) & 0xFF];
+				std::copy(floats.begin(), floats.end(), out + byte * 8);
+			}
+
+			if constexpr (size % 8 != 0) //the bits after the last whole byte, if any. packed[size / 64] is out of range when size is a multiple of 64
+			{
+				const auto& last_byte = byte_floats_[(packed[size / 64] >> (size % 64 / 8 * 8)) & 0xFF];
+				std::copy_n(last_byte.begin(), size % 8, out + size / 8 * 8);
+			}
+		}
+
+		static constexpr auto byte_floats_ = []()
+		{
+			std::array<std::array<float, 8>, 256> floats{};
+
+			for (size_t byte = 0; byte < floats.size(); ++byte)
+			{
+				for (size_t bit = 0; bit < 8; ++bit) floats[byte][bit] = static_cast<float>((byte >> bit) & 1u);
+			}
+
+			return floats;
+		}();
+
+		static constexpr std::array<std::uint8_t, configuration_t::max_score> first_copy_ = []() //where each identity starts in the discard field
+		{
+			std::array<std::uint8_t, configuration_t::max_score> copies{};
+
+			std::apply([&] <typename... Colors, typename... Ranks, size_t... Freqs> (const card_frequency<Colors, Ranks, Freqs>&...)
+			{
+				((copies[card_state<Configuration>::template identity_of<Colors, Ranks>()] += static_cast<std::uint8_t>(Freqs)), ...);
+			}, typename configuration_t::card_frequencies{});
+
+			std::exclusive_scan(copies.begin(), copies.end(), copies.begin(), std::uint8_t{ 0 });
+			return copies;
+		}();
+	};
+
+	template <typename Configuration>
+	struct relative_action //actions numbered from the point of view of the player to act, for learning code with a fixed action space
+	{
+		//playing hand slot n is n, discarding it is hand_size + n, and hints follow at 2 * hand_size + (seats after the actor - 1) * num_properties + property, colors before ranks
+
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+		using actions_t = typename Configuration::template actions<std::variant>;
+
+		static constexpr size_t num_properties = configuration_t::num_colors + configuration_t::num_ranks;
+		static constexpr size_t num_actions = configuration_t::max_num_actions;
+
+		static constexpr size_t index_of(const game_state<Configuration>& state, const actions_t& taken) noexcept
+		{
+			return std::visit([&] <typename Action> (const Action& a) -> size_t
+			{
+				if constexpr (std::is_same_v<Action, action<play>> || std::is_same_v<Action, action<discard>>)
+				{
+					const auto hand = state.hand_of(state.player_turn_);
+					const auto slot = static_cast<size_t>(std::find(hand.begin(), hand.end(), static_cast<std::uint8_t>(a.a_.card_)) - hand.begin());
+
+					return std::is_same_v<Action, action<play>> ? slot : configuration_t::hand_size + slot;
+				}
+				else
+				{
+					const auto seats_after = (a.player_ - state.player_turn_ + static_cast<int>(configuration_t::num_players)) % static_cast<int>(configuration_t::num_players);
+					const auto hint_code = action_code<Configuration>::encode(a) - 2 * configuration_t::deck_size;
+
+					return 2 * configuration_t::hand_size + (seats_after - 1) * num_properties + hint_code % num_properties;
+				}
+			}, taken);
+		}
+
+		static constexpr std::optional<actions_t> action_at(const game_state<Configuration>& state, size_t index) //nullopt for a slot that is empty, the action may still be illegal
+		{
+			const auto hand = state.hand_of(state.player_turn_);
+
+			if (index < 2 * configuration_t::hand_size)
+			{
+				const auto slot = index % configuration_t::hand_size;
+				if (slot >= hand.size()) return std::nullopt;
+
+				return action_code<Configuration>::decode(static_cast<std::uint8_t>(hand[slot] + (index < configuration_t::hand_size ? 0 : configuration_t::deck_size)));
+			}
+
+			if (index >= num_actions) return std::nullopt;
+
+			const auto hint_index = index - 2 * configuration_t::hand_size;
+			auto target = state.player_turn_;
+			for (size_t seat = 0; seat <= hint_index / num_properties; ++seat) target = game_state<Configuration>::next_player(target);
+
+			return action_code<Configuration>::decode(static_cast<std::uint8_t>(2 * configuration_t::deck_size + target * num_properties + hint_index % num_properties));
+		}
+
+		static constexpr void legal(const game_state<Configuration>& state, std::span<std::uint8_t, num_actions> mask) noexcept
+		{
+			std::fill(mask.begin(), mask.end(), std::uint8_t{ 0 });
+			if (state.is_over()) return;
+
+			for_each_possible_action(state, [&](const auto& possible_action)
+				{
+					mask[index_of(state, possible_action)] = 1;
+				});
+		}
+	};
+
+	namespace controller
+	{
+		//controllers that keep the game's generator take its type as their second template argument, std::mt19937 unless given.
+		//game::run swaps it for the type of the generator the game is run with, so a controller can be named without one
+		template <typename Controller, typename Gen>
+		struct with_generator
+		{
+			using type = Controller;
+		};
+
+		template <template <typename, typename> typename Controller, typename Configuration, typename Default, typename Gen>
+		struct with_generator<Controller<Configuration, Default>, Gen>
+		{
+			using type = Controller<Configuration, Gen>;
+		};
+
+		template <typename Controller, typename Gen>
+		using with_generator_t = typename with_generator<Controller, Gen>::type;
+
+		struct options //given by game::run to every controller that takes it after the generator
+		{
+			unsigned search_workers_ = 1; //threads a searching controller uses for one decision, the calling thread included
+		};
+
+		template <typename Controller>
+		struct player_controller
+		{
+			Controller control_;
+
+			template <typename... TArgs>
+				player_controller(TArgs &&... args) : control_(std::in_place, std::forward<TArgs>(args)...)
+			{
+			}
+
+			template <typename GameState, typename Belief, typename Sink>
+			auto perform(const GameState& state, const Belief& beliefs, Sink& out) //controllers that render get the game's sink, those that do not use beliefs only get the state
+			{
+				if constexpr (requires { control_.perform(state, out); }) return control_.perform(state, out);
+				else if constexpr (requires { control_.perform(state, beliefs); }) return control_.perform(state, beliefs);
+				else return control_.perform(state);
+			}
+		};
+
+		template <typename Controller, typename Gen>
+		player_controller<Controller> make_player_controller(Gen& gen, const options& chosen)
+		{
+			if constexpr (std::is_constructible_v<Controller, std::in_place_t, Gen&, const options&>) return player_controller<Controller>(gen, chosen);
+			else return player_controller<Controller>(gen);
+		}
+
+		template <typename Configuration, typename Gen = std::mt19937>
+		struct human
+		{
+			Gen& gen_;
+
+			human(std::in_place_t, Gen& gen) : gen_(gen)
+			{
+
+			}
+
+			static void print_player_know(std::ostream& stream, const game_state<Configuration>& state, int player)
+			{
+				stream << "    \t| " << "rank      " << " | " << "color     " << '\n';
+
+				stream << "card\t| ";
+
+				std::apply([&] <typename... Ranks> (Ranks &&...)
+				{
+					[[maybe_unused]] char dummy = ((stream << Ranks::display_rank() << ' ', 0), ...);
+				}, typename Configuration::template ranks<std::tuple>{});
+
+				stream << " | ";
+
+				std::apply([&] <typename... Colors> (Colors &&...)
+				{
+					[[maybe_unused]] char dummy = ((stream << Colors::display_color() << Colors::display_name()[0] << termcolor::reset << ' ', 0), ...);
+				}, typename Configuration::template colors<std::tuple>{});
+
+				stream << '\n';
+
+				stream << "--------|------------|-----------\n";
+
+				for (const int i : state.hand_of(player))
+				{
+					const auto& card_in_deck = state.deck_.cards_[i];
+					stream << '#' << i << ' ';
+
+					if (player != state.player_turn_)
+					{
+						card_in_deck.get_card().display_card(stream);
+					}
+
+					stream << "\t| ";
+
+					for (size_t r = 0; r < configuration::configuration_traits<Configuration>::num_ranks; ++r)
+					{
+						stream << card_in_deck.knowledge_.is_rank_possible(r) << ' ';
+					}
+
+					stream << " | ";
+
+					for (size_t c = 0; c < configuration::configuration_traits<Configuration>::num_colors; ++c)
+					{
+						stream << card_in_deck.knowledge_.is_color_possible(c) << ' ';
+					}
+
+					stream << '\n';
+				}
+			}
+			static void print_know(std::ostream& stream, const game_state<Configuration>& state)
+			{
+				stream << "your know:\n";
+				print_player_know(stream, state, state.player_turn_);
+
+				for (int partner = game_state<Configuration>::next_player(state.player_turn_); partner != state.player_turn_; partner = game_state<Configuration>::next_player(partner))
+				{
+					stream << "player " << partner << " knows:\n";
+					print_player_know(stream, state, partner);
+				}
+			}
+
+			template <typename Sink>
+			typename Configuration::template actions<std::variant> perform(const game_state<Configuration>& state, Sink& out) //the prompt goes to the game's sink, so a headless game compiles it out
+			{
+				auto possible_actions = find_all_possible_actions(state);
+
+				std::uniform_int_distribution<size_t> dis(0, possible_actions.size() - 1);
+				auto choice = dis(gen_);
+
+				if constexpr (Sink::enabled)
+				{
+					auto& stream = out.stream();
+
+					print_know(stream, state);
+
+					stream << "You may take one of " << possible_actions.size() << " actions.\n";
+
+					for (int i = 0; i < possible_actions.size(); ++i)
+					{
+						std::visit([&](const auto& action)
+							{
+								stream << '\t' << i << ". ";
+								action.display_hidden_action(stream, state);
+							}, possible_actions[i]);
+					}
+
+					stream << "I will randomly play for you. " << "Your choice is " << choice << ".\n";
+					out.flush();
+				}
+
+				return possible_actions[choice];
+			}
+
+		};
+
+		template <typename Configuration, typename Gen = std::mt19937>
+		struct random_ai
+		{
+			Gen& gen_;
+
+			random_ai(std::in_place_t, Gen& gen) : gen_(gen)
+			{
+			}
+
+			typename Configuration::template actions<std::variant> perform(const game_state<Configuration>& state)
+			{
+				auto possible_actions = find_all_possible_actions(state);
+
+				std::uniform_int_distribution<size_t> dis(0, possible_actions.size() - 1);
+
+				return possible_actions[dis(gen_)];
+			}
+
+		};
+
+		template <typename Configuration>
+		struct rule_based //deterministic conventions from knowledge<> and visible cards only, cheap enough to drive rollouts and mass evaluations
+		{
+			//a player plays cards they know are playable, and clued cards that are playable at even odds or better while a mistake can be afforded.
+			//as every player can work out what a partner will do, clues are never given when they would lead to a misplay, and clues that stop one come first.
+			//next are saves of critical cards about to be discarded from the chop, the oldest untouched card, then the clue that sets up the most plays.
+			//otherwise discard a card known to be useless, the chop, or the card least likely to be critical.
+
+			using configuration_t = typename configuration::configuration_traits<Configuration>;
+			using actions_t = typename Configuration::template actions<std::variant>;
+			using identity_mask_t = typename belief<Configuration>::identity_mask_t;
+
+			template <typename Gen>
+			rule_based(std::in_place_t, Gen&)
+			{
+			}
+
+			actions_t perform(const game_state<Configuration>& state) const
+			{
+				belief<Configuration> beliefs;
+				beliefs.reset(state);
+				return choose(state, beliefs);
+			}
+
+			actions_t perform(const game_state<Configuration>& state, const belief<Configuration>& beliefs) const
+			{
+				return choose(state, beliefs);
+			}
+
+			static actions_t choose(const game_state<Configuration>& state, const belief<Configuration>& beliefs)
+			{
+				const auto me = state.player_turn_;
+				const auto hand = state.hand_of(me);
+				const auto playable = belief<Configuration>::playable(state);
+
+				for (const int card_in_hand : hand)
+				{
+					if (is_certain(beliefs, me, state.deck_.cards_[card_in_hand].knowledge_, playable)) return action{ play{ card_in_hand } };
+				}
+
+				for (const int card_in_hand : hand)
+				{
+					if (will_play(state, beliefs, me, state.deck_.cards_[card_in_hand].knowledge_, playable)) return action{ play{ card_in_hand } };
+				}
+
+				if (state.num_available_hints_ > 0)
+				{
+					const int next = game_state<Configuration>::next_player(me);
+					const int next_chop = chop(state, next);
+					const bool chop_needs_saving = next_chop >= 0 && ((beliefs.critical(state) & ~playable) >> state.deck_.cards_[next_chop].identity_) & 1u;
+
+					std::array<std::array<bool, configuration_t::hand_size>, configuration_t::num_players> plays_now{}; //what each partner would do before any clue
+
+					for (int partner = next; partner != me; partner = game_state<Configuration>::next_player(partner))
+					{
+						const auto partner_hand = state.hand_of(partner);
+
+						for (size_t slot = 0; slot < partner_hand.size(); ++slot)
+						{
+							plays_now[partner][slot] = will_play(state, beliefs, partner, state.deck_.cards_[partner_hand[slot]].knowledge_, playable);
+						}
+					}
+
+					std::optional<actions_t> fix, save, best_clue;
+					int best_num_plays = 0;
+
+					for_each_possible_action(state, [&](const auto& possible_action)
+						{
+							if constexpr (requires { possible_action.player_; })
+							{
+								const bool any_clue_will_do = state.num_available_hints_ >= Configuration::max_num_hints && !best_clue.has_value();
+								const auto evaluated = evaluate(state, beliefs, playable, possible_action, plays_now[possible_action.player_], chop_needs_saving ? next_chop : -1, any_clue_will_do);
+
+								if (!evaluated.has_value() || evaluated->misleads_) return;
+
+								const auto& outcome = evaluated.value();
+
+								if (outcome.num_fixes_ > 0 && !fix.has_value()) fix = possible_action;
+								if (chop_needs_saving && outcome.touches_chop_ && possible_action.player_ == next && !save.has_value()) save = possible_action;
+								if (outcome.num_new_plays_ > best_num_plays || !best_clue.has_value())
+								{
+									best_num_plays = std::max(best_num_plays, outcome.num_new_plays_);
+									best_clue = possible_action;
+								}
+							}
+						});
+
+					if (fix.has_value()) return fix.value();
+					if (save.has_value()) return save.value();
+					if (best_num_plays > 0 || (state.num_available_hints_ >= Configuration::max_num_hints && best_clue.has_value())) return best_clue.value(); //a clue rather than a wasted discard
+				}
+
+				const auto useless = beliefs.useless(state);
+
+				for (const int card_in_hand : hand)
+				{
+					if (is_certain(beliefs, me, state.deck_.cards_[card_in_hand].knowledge_, useless)) return action{ discard{ card_in_hand } };
+				}
+
+				if (const int my_chop = chop(state, me); my_chop >= 0) return action{ discard{ my_chop } };
+
+				const auto critical = beliefs.critical(state);
+				const auto safest = std::min_element(hand.begin(), hand.end(), [&](std::uint8_t a, std::uint8_t b)
+					{
+						return beliefs.probability(state, a, critical) < beliefs.probability(state, b, critical);
+					});
+
+				return action{ discard{ *safest } };
+			}
+
+		private:
+
+			struct clue_outcome
+			{
+				int num_new_plays_ = 0; //playable cards the hinted player will now play
+				int num_fixes_ = 0; //unplayable cards the hinted player will no longer play
+				bool misleads_ = false; //the hinted player would play an unplayable card
+				bool touches_chop_ = false;
+			};
+
+			static bool is_touched(const knowledge<Configuration>& known) noexcept //a clue has named its color or rank
+			{
+				return known.clued_;
+			}
+
+			static int chop(const game_state<Configuration>& state, int player) //oldest card no clue has touched, -1 when every card has been
+			{
+				for (const int card_in_hand : state.hand_of(player))
+				{
+					if (!is_touched(state.deck_.cards_[card_in_hand].knowledge_)) return card_in_hand;
+				}
+
+				return -1;
+			}
+
+			static bool is_certain(const belief<Configuration>& beliefs, int player, const knowledge<Configuration>& known, identity_mask_t identities) //every identity player still thinks possible is in identities
+			{
+				const auto candidates = beliefs.candidates(player, known);
+				return candidates != 0 && (candidates & ~identities) == 0;
+			}
+
+			static bool will_play(const game_state<Configuration>& state, const belief<Configuration>& beliefs, int player, const knowledge<Configuration>& known, identity_mask_t playable)
+			{
+				const auto candidates = beliefs.candidates(player, known);
+
+				if (candidates == 0) return false;
+				if ((candidates & ~playable) == 0) return true;
+				if (!is_touched(known) || state.num_mistakes_ + 1 >= configuration_t::max_num_mistakes) return false;
+
+				return 2 * beliefs.weight(player, candidates & playable) >= beliefs.weight(player, candidates);
+			}
+
+			template <typename Property>
+			static std::optional<clue_outcome> evaluate(const game_state<Configuration>& state, const belief<Configuration>& beliefs, identity_mask_t playable,
+				const hint<Property>& clue, const std::array<bool, configuration_t::hand_size>& plays_now, int chop_to_save, bool any_clue_will_do)
+			{
+				constexpr auto hinted_bit = property_bit<Property, Configuration>();
+
+				clue_outcome outcome;
+				const auto hand = state.hand_of(clue.player_);
+
+				bool worth_evaluating = any_clue_will_do; //only clues that touch a playable card, the chop to save, or a hand with a pending misplay can matter
+
+				for (size_t slot = 0; slot < hand.size() && !worth_evaluating; ++slot)
+				{
+					const auto& card_in_deck = state.deck_.cards_[hand[slot]];
+					const bool is_playable = (playable >> card_in_deck.identity_) & 1u;
+
+					worth_evaluating = (has_property<Property>(card_in_deck) && (is_playable || hand[slot] == chop_to_save)) || (plays_now[slot] && !is_playable);
+				}
+
+				if (!worth_evaluating) return std::nullopt;
+
+				for (size_t slot = 0; slot < hand.size(); ++slot)
+				{
+					const int card_in_hand = hand[slot];
+					const auto& card_in_deck = state.deck_.cards_[card_in_hand];
+					auto known = card_in_deck.knowledge_;
+					auto& hinted = is_property_a_color_v<Property, Configuration> ? known.hinted_colors_ : known.hinted_ranks_;
+
+					if (has_property<Property>(card_in_deck))
+					{
+						hinted = hinted_bit;
+						known.clued_ = true;
+						outcome.touches_chop_ |= card_in_hand == chop_to_save;
+					}
+					else
+					{
+						hinted &= static_cast<std::uint8_t>(~hinted_bit);
+					}
+
+					const bool is_playable = (playable >> card_in_deck.identity_) & 1u;
+					const bool played_before = plays_now[slot];
+					const bool played_after = will_play(state, beliefs, clue.player_, known, playable);
+
+					outcome.num_new_plays_ += is_playable && played_after && !played_before;
+					outcome.num_fixes_ += !is_playable && played_before && !played_after;
+					outcome.misleads_ |= !is_playable && played_after;
+				}
+
+				return outcome;
+			}
+		};
+
+		template <typename Configuration, typename Gen = std::mt19937>
+		struct mcts //determinized monte carlo tree search over the information set of the player to move, one tree per worker
+		{
+			using configuration_t = typename configuration::configuration_traits<Configuration>;
+			using actions_t = typename Configuration::template actions<std::variant>;
+
+			enum class rollout_policy
+			{
+				greedy, //play any playable card of the determinized deal, otherwise a random other action
+				rule_based, //controller::rule_based for every player
+			};
+
+			struct settings
+			{
+				size_t iterations_ = 4000; //split over the workers, unused when there is a time budget
+				std::optional<std::chrono::microseconds> time_budget_;
+				unsigned num_workers_ = 1; //one tree each, searched by the calling thread and threads kept for as long as the controller. results for a seed depend on it
+				double exploration_ = 0.7;
+				rollout_policy rollout_ = rollout_policy::rule_based; //greedy rollouts are cheaper but play far below the rule based bot
+			};
+
+			Gen& gen_;
+			settings settings_;
+			std::unique_ptr<parallel::worker_pool> pool_; //only with more than one worker
+
+			mcts(std::in_place_t, Gen& gen, settings search_settings = {}) : gen_(gen), settings_(search_settings)
+			{
+				if (settings_.num_workers_ > 1) pool_ = std::make_unique<parallel::worker_pool>(settings_.num_workers_);
+			}
+
+			mcts(std::in_place_t, Gen& gen, const options& chosen) : mcts(std::in_place, gen, with_workers(chosen.search_workers_))
+			{
+			}
+
+			static settings with_workers(unsigned num_workers) //the default settings otherwise
+			{
+				settings search_settings;
+				search_settings.num_workers_ = num_workers;
+				return search_settings;
+			}
+
+			actions_t perform(const game_state<Configuration>& state)
+			{
+				const auto num_workers = std::max(1u, settings_.num_workers_);
+				const auto iterations_per_worker = (settings_.iterations_ + num_workers - 1) / num_workers;
+				const auto deadline = settings_.time_budget_.has_value()
+					? std::make_optional(std::chrono::steady_clock::now() + settings_.time_budget_.value())
+					: std::nullopt;
+
+				std::vector<search_tree> trees(num_workers);
+				for (auto& tree : trees) tree.gen_.seed(gen_()); //seeded up front so a fixed iteration budget is reproducible
+
+				const auto search = [&](size_t tree) { trees[tree].search(state, settings_, iterations_per_worker, deadline); };
+
+				if (pool_ != nullptr) pool_->run(trees.size(), search);
+				else search(0);
+
+				std::vector<std::pair<const node*, std::uint64_t>> root_visits; //visits of each root action summed over the trees
+
+				for (const auto& tree : trees)
+				{
+					for (auto child = tree.nodes_.front().first_child_; child != node::none; child = tree.nodes_[child].next_sibling_)
+					{
+						const auto& child_node = tree.nodes_[child];
+						auto merged = std::find_if(root_visits.begin(), root_visits.end(), [&](const auto& v) { return v.first->code_ == child_node.code_; });
+
+						if (merged == root_visits.end()) root_visits.emplace_back(&child_node, child_node.visits_);
+						else merged->second += child_node.visits_;
+					}
+				}
+
+				if (root_visits.empty()) return find_all_possible_actions(state)[0];
+
+				return action_code<Configuration>::decode(std::max_element(root_visits.begin(), root_visits.end(), [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; })->first->code_);
+			}
+
+			//redeals the cards player cannot see (their own hand and the draw pile) so that their hand agrees with their hints, uniformly over such deals
+			template <typename URBG>
+			static game_state<Configuration> determinize(const game_state<Configuration>& state, int player, URBG& gen)
+			{
+				return deal_sampler<Configuration>(state, player).determinize(state, gen);
+			}
+
+		private:
+
+			struct node
+			{
+				static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+				std::uint8_t code_ = 0; //action_code of the action leading to this node
+				std::uint32_t first_child_ = none;
+				std::uint32_t next_sibling_ = none;
+				std::uint32_t visits_ = 0;
+				std::uint32_t availability_ = 0;
+				double total_reward_ = 0.0;
+			};
+
+			struct search_tree
+			{
+				std::vector<node> nodes_;
+				std::mt19937 gen_;
+
+				void search(const game_state<Configuration>& root_state, const settings& search_settings, size_t iterations, std::optional<std::chrono::steady_clock::time_point> deadline)
+				{
+					nodes_.assign(1, node{});
+					std::vector<std::uint32_t> path;
+					const deal_sampler<Configuration> sampler(root_state, root_state.player_turn_); //made once, every iteration redeals the same hidden cards
+
+					for (size_t iteration = 0; deadline.has_value() ? std::chrono::steady_clock::now() < deadline.value() : iteration < iterations; ++iteration)
+					{
+						auto state = sampler.determinize(root_state, gen_);
+
+						path.assign(1, 0);
+						select_and_expand(state, search_settings.exploration_, path);
+
+						if (search_settings.rollout_ == rollout_policy::rule_based)
+						{
+							belief<Configuration> beliefs;
+							beliefs.reset(state);
+
+							while (!state.is_over())
+							{
+								std::visit([&](const auto& a)
+									{
+										beliefs.observe(state, a);
+										a.apply(state);
+									}, rule_based<Configuration>::choose(state, beliefs));
+							}
+						}
+						else
+						{
+							while (!state.is_over()) apply_rollout_action(state);
+						}
+
+						const double reward = static_cast<double>(state.score()) / configuration_t::max_score;
+
+						for (const auto visited : path)
+						{
+							++nodes_[visited].visits_;
+							nodes_[visited].total_reward_ += reward;
+						}
+					}
+				}
+
+				void select_and_expand(game_state<Configuration>& state, double exploration, std::vector<std::uint32_t>& path)
+				{
+					while (!state.is_over())
+					{
+						const auto current = path.back();
+						const auto possible_actions = find_all_possible_actions(state);
+
+						std::uint32_t best_child = node::none;
+						double best_value = -1.0;
+						size_t num_untried = 0;
+						std::optional<std::uint8_t> untried;
+
+						for (const auto& possible_action : possible_actions)
+						{
+							const auto code = action_code<Configuration>::encode(possible_action);
+							auto child = nodes_[current].first_child_;
+							while (child != node::none && nodes_[child].code_ != code) child = nodes_[child].next_sibling_;
+
+							if (child == node::none)
+							{
+								if (std::uniform_int_distribution<size_t>(0, num_untried++)(gen_) == 0) untried = code;
+								continue;
+							}
+
+							auto& child_node = nodes_[child];
+							++child_node.availability_;
+
+							const double value = child_node.total_reward_ / child_node.visits_
+								+ exploration * std::sqrt(std::log(static_cast<double>(child_node.availability_)) / child_node.visits_);
+
+							if (value > best_value)
+							{
+								best_value = value;
+								best_child = child;
+							}
+						}
+
+						if (untried)
+						{
+							node expanded{ untried.value() };
+							expanded.next_sibling_ = nodes_[current].first_child_;
+							nodes_[current].first_child_ = static_cast<std::uint32_t>(nodes_.size());
+							path.push_back(static_cast<std::uint32_t>(nodes_.size()));
+							nodes_.push_back(expanded);
+
+							action_code<Configuration>::apply(state, untried.value());
+							return;
+						}
+
+						path.push_back(best_child);
+						action_code<Configuration>::apply(state, nodes_[best_child].code_);
+					}
+				}
+
+				void apply_rollout_action(game_state<Configuration>& state) //the determinized deal is known here, so never waste a playable card
+				{
+					for (const int card_in_hand : state.hand_of(state.player_turn_))
+					{
+						if (play{ card_in_hand }.is_playable(state))
+						{
+							action{ play{ card_in_hand } }.apply(state);
+							return;
+						}
+					}
+
+					actions_t chosen;
+					size_t num_seen = 0;
+
+					for_each_possible_action(state, [&](const auto& possible_action)
+						{
+							if constexpr (!std::is_same_v<std::remove_cvref_t<decltype(possible_action)>, action<play>>)
+							{
+								if (std::uniform_int_distribution<size_t>(0, num_seen++)(gen_) == 0) chosen = possible_action;
+							}
+						});
+
+					std::visit([&](const auto& a) { a.apply(state); }, chosen);
+				}
+			};
+		};
+
+		template <typename Configuration>
+		struct evaluated //a seat whose decisions come from the evaluator of a multiplex:: scheduler, it can only sit at a game run through game::play
+		{
+			using actions_t = typename Configuration::template actions<std::variant>;
+
+			template <typename Gen>
+			evaluated(std::in_place_t, Gen&)
+			{
+			}
+
+			actions_t perform(const game_state<Configuration>&) const
+			{
+				throw std::logic_error("an evaluated seat only gets decisions from a multiplex:: scheduler");
+			}
+		};
+
+		template <typename Configuration, size_t... Ns, typename... Controllers, typename Sink>
+		auto choose_player_controller_action_impl(const game_state<Configuration>& state, const belief<Configuration>& beliefs, std::index_sequence<Ns...>, std::tuple<player_controller<Controllers>...>& player_controllers, Sink& out)
+		{
+			
+			std::optional<typename Configuration::template actions<std::variant>> action;
+
+			[[maybe_unused]] bool dummy = ((action == std::nullopt && (((state.player_turn_ == Ns) ? action = std::get<Ns>(player_controllers).perform(state, beliefs, out) : action = std::nullopt), true)) && ...);
+
+			return action.value();
+		}
+
+		template <typename Configuration, typename... Controllers, typename Sink>
+		auto choose_player_controller_action(const game_state<Configuration>& state, const belief<Configuration>& beliefs, std::tuple<player_controller<Controllers>...>& player_controllers, Sink& out) //by reference, controllers keep their state between turns
+		{
+			return choose_player_controller_action_impl(state, beliefs, std::make_index_sequence<sizeof...(Controllers)>{}, player_controllers, out);
+		}
+	}
+
+	namespace history
+	{
+		template <typename Configuration>
+		class full //every state of the game, and the action that led to it
+		{
+		public:
+
+			using action_t = typename Configuration::template actions<std::variant>;
+
+			void reset(const game_state<Configuration>& initial_state)
+			{
+				states_.assign(1, initial_state);
+				codes_.clear();
+			}
+
+			void push(const game_state<Configuration>& next_state, const action_t& action)
+			{
+				states_.push_back(next_state);
+				codes_.push_back(action_code<Configuration>::encode(action));
+			}
+
+			const game_state<Configuration>& current() const { return states_.back(); }
+			size_t num_turns() const { return codes_.size(); }
+
+			game_state<Configuration> state_at(size_t turn) const { return states_[turn]; }
+			action_t action_at(size_t turn) const { return action_code<Configuration>::decode(codes_[turn]); } //action taken from state_at(turn)
+			std::uint8_t code_at(size_t turn) const { return codes_[turn]; }
+
+		private:
+
+			std::vector<game_state<Configuration>> states_;
+			std::vector<std::uint8_t> codes_; //action_code of each action
+		};
+
+		template <typename Configuration, size_t CheckpointInterval = 16>
+		class compact //the deal and the action list, plus a state every CheckpointInterval turns to replay from
+		{
+		public:
+
+			static_assert(CheckpointInterval > 0, "Checkpoint interval must be at least one turn.");
+
+			using action_t = typename Configuration::template actions<std::variant>;
+
+			void reset(const game_state<Configuration>& initial_state)
+			{
+				checkpoints_.assign(1, initial_state);
+				codes_.clear();
+				current_ = initial_state;
+			}
+
+			void push(const game_state<Configuration>& next_state, const action_t& action)
+			{
+				codes_.push_back(action_code<Configuration>::encode(action));
+				current_ = next_state;
+
+				if (codes_.size() % CheckpointInterval == 0) checkpoints_.push_back(next_state);
+			}
+
+			const game_state<Configuration>& current() const { return current_; }
+			size_t num_turns() const { return codes_.size(); }
+
+			game_state<Configuration> state_at(size_t turn) const
+			{
+				auto state = checkpoints_[turn / CheckpointInterval];
+
+				for (size_t replayed = turn - turn % CheckpointInterval; replayed < turn; ++replayed)
+				{
+					action_code<Configuration>::apply(state, codes_[replayed]);
+				}
+
+				return state;
+			}
+
+			action_t action_at(size_t turn) const { return action_code<Configuration>::decode(codes_[turn]); } //action taken from state_at(turn)
+			std::uint8_t code_at(size_t turn) const { return codes_[turn]; }
+
+		private:
+
+			std::vector<game_state<Configuration>> checkpoints_; //checkpoints_[0] is the initial deal
+			std::vector<std::uint8_t> codes_; //action_code of each action
+			game_state<Configuration> current_;
+		};
+	}
+
+	namespace instrument //per turn timings inside game::run, compiled in only with HANABI_INSTRUMENT defined
+	{
+#if defined(HANABI_INSTRUMENT)
+		inline constexpr bool enabled = true;
+#else
+		inline constexpr bool enabled = false;
+#endif
+
+		enum class phase : std::uint8_t { decide, observe, perform, display };
+		enum class action_kind : std::uint8_t { play, discard, hint_color, hint_rank };
+
+		inline constexpr std::array<std::string_view, 4> phase_names = { "decide", "observe", "perform", "display" };
+		inline constexpr std::array<std::string_view, 4> action_kind_names = { "play", "discard", "hint_color", "hint_rank" };
+		inline constexpr std::uint8_t no_action = 0xFF;
+
+		template <typename Configuration, typename Action>
+		constexpr action_kind kind_of(const Action&) noexcept
+		{
+			if constexpr (std::is_same_v<Action, action<play>>) return action_kind::play;
+			else if constexpr (std::is_same_v<Action, action<discard>>) return action_kind::discard;
+			else return action_code<Configuration>::encode(Action{}) - 2 * configuration::configuration_traits<Configuration>::deck_size < configuration::configuration_traits<Configuration>::num_colors ? action_kind::hint_color : action_kind::hint_rank;
+		}
+
+		struct event
+		{
+			std::uint64_t start_ns_; //since the first event of the process
+			std::uint64_t duration_ns_; //searches and solver phases can run longer than 32 bits of nanoseconds
+			std::uint16_t turn_;
+			phase phase_;
+			std::uint8_t action_kind_; //no_action for spans that do not know the action yet
+		};
+
+		struct thread_buffer //written only by its own thread, read once the threads are done
+		{
+			static constexpr size_t max_events = size_t{ 1 } << 20; //later spans still count towards the totals
+
+			std::vector<event> events_;
+			std::uint64_t num_dropped_ = 0;
+			std::array<std::uint64_t, phase_names.size()> phase_counts_{};
+			std::array<std::uint64_t, phase_names.size()> phase_ns_{};
+			std::array<std::uint64_t, action_kind_names.size()> action_counts_{};
+			std::array<std::uint64_t, action_kind_names.size()> action_perform_ns_{};
+		};
+
+		class registry
+		{
+		public:
+
+			static registry& get()
+			{
+				static registry instance;
+				return instance;
+			}
+
+			thread_buffer& local()
+			{
+				thread_local thread_buffer* buffer = [this]()
+				{
+					std::scoped_lock lock(mutex_);
+					return buffers_.emplace_back(std::make_unique<thread_buffer>()).get();
+				}();
+
+				return *buffer;
+			}
+
+			std::uint64_t now_ns() const noexcept
+			{
+				return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch_).count());
+			}
+
+			template <typename Visitor> //visit(thread index, buffer), not safe while games are running
+			void for_each_buffer(Visitor&& visit)
+			{
+				std::scoped_lock lock(mutex_);
+				for (size_t thread = 0; thread < buffers_.size(); ++thread) visit(thread, *buffers_[thread]);
+			}
+
+		private:
+
+			std::mutex mutex_;
+			std::vector<std::unique_ptr<thread_buffer>> buffers_; //owned here so they outlive their threads
+			std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+		};
+
+		template <bool Enabled = enabled>
+		class span //times its own lifetime
+		{
+		public:
+
+			span(phase timed, size_t turn) noexcept : buffer_(registry::get().local()), start_ns_(registry::get().now_ns()), turn_(static_cast<std::uint16_t>(turn)), phase_(timed) {}
+
+			span(const span&) = delete;
+			span& operator=(const span&) = delete;
+
+			~span()
+			{
+				const auto duration_ns = registry::get().now_ns() - start_ns_;
+				const auto index = static_cast<size_t>(phase_);
+
+				++buffer_.phase_counts_[index];
+				buffer_.phase_ns_[index] += duration_ns;
+
+				if (action_kind_ != no_action) buffer_.action_perform_ns_[action_kind_] += duration_ns;
+
+				if (buffer_.events_.size() < thread_buffer::max_events) buffer_.events_.push_back({ start_ns_, duration_ns, turn_, phase_, action_kind_ });
+				else ++buffer_.num_dropped_;
+			}
+
+			void set_action(action_kind kind) noexcept
+			{
+				action_kind_ = static_cast<std::uint8_t>(kind);
+				++buffer_.action_counts_[action_kind_];
+			}
+
+		private:
+
+			thread_buffer& buffer_;
+			std::uint64_t start_ns_;
+			std::uint16_t turn_;
+			phase phase_;
+			std::uint8_t action_kind_ = no_action;
+		};
+
+		template <>
+		class span<false> //compiles away
+		{
+		public:
+
+			constexpr span(phase, size_t) noexcept {}
+			constexpr void set_action(action_kind) noexcept {}
+		};
+
+		inline void write_microseconds(std::ostream& stream, std::uint64_t ns) //exact to the nanosecond, a double would round long runs to whole microseconds
+		{
+			const auto fraction = ns % 1000;
+			stream << ns / 1000 << '.' << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + fraction / 10 % 10) << static_cast<char>('0' + fraction % 10);
+		}
+
+		inline void write_chrome_trace(std::ostream& stream) //trace event json, for chrome://tracing or ui.perfetto.dev
+		{
+			stream << "{\"traceEvents\":[";
+
+			bool first = true;
+			registry::get().for_each_buffer([&](size_t thread, const thread_buffer& buffer)
+				{
+					for (const auto& timed : buffer.events_)
+					{
+						stream << (first ? "\n" : ",\n") << "{\"name\":\"" << phase_names[static_cast<size_t>(timed.phase_)] << "\",\"cat\":\"turn\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread << ",\"ts\":";
+						write_microseconds(stream, timed.start_ns_);
+						stream << ",\"dur\":";
+						write_microseconds(stream, timed.duration_ns_);
+						stream << ",\"args\":{\"turn\":" << timed.turn_;
+						if (timed.action_kind_ != no_action) stream << ",\"action\":\"" << action_kind_names[timed.action_kind_] << '"';
+						stream << "}}";
+						first = false;
+					}
+				});
+
+			stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+		}
+
+		inline void write_summary(std::ostream& stream)
+		{
+			thread_buffer total;
+
+			registry::get().for_each_buffer([&](size_t, const thread_buffer& buffer)
+				{
+					total.num_dropped_ += buffer.num_dropped_;
+					for (size_t i = 0; i < phase_names.size(); ++i)
+					{
+						total.phase_counts_[i] += buffer.phase_counts_[i];
+						total.phase_ns_[i] += buffer.phase_ns_[i];
+					}
+					for (size_t i = 0; i < action_kind_names.size(); ++i)
+					{
+						total.action_counts_[i] += buffer.action_counts_[i];
+						total.action_perform_ns_[i] += buffer.action_perform_ns_[i];
+					}
+				});
+
+			const auto all_ns = std::accumulate(total.phase_ns_.begin(), total.phase_ns_.end(), std::uint64_t{ 0 });
+
+			stream << "phase\t\tspans\t\ttotal ms\tmean ns\t\tshare\n";
+			for (size_t i = 0; i < phase_names.size(); ++i)
+			{
+				if (total.phase_counts_[i] == 0) continue;
+				stream << phase_names[i] << "\t\t" << total.phase_counts_[i] << "\t\t" << total.phase_ns_[i] / 1e6 << "\t\t" << total.phase_ns_[i] / total.phase_counts_[i]
+					<< "\t\t" << 100.0 * total.phase_ns_[i] / std::max<std::uint64_t>(all_ns, 1) << "%\n";
+			}
+
+			stream << "action\t\tcount\t\tperform ms\tmean ns\n";
+			for (size_t i = 0; i < action_kind_names.size(); ++i)
+			{
+				if (total.action_counts_[i] == 0) continue;
+				stream << action_kind_names[i] << "\t" << (action_kind_names[i].size() < 8 ? "\t" : "") << total.action_counts_[i] << "\t\t" << total.action_perform_ns_[i] / 1e6
+					<< "\t\t" << total.action_perform_ns_[i] / total.action_counts_[i] << '\n';
+			}
+
+			if (total.num_dropped_ > 0) stream << "spans left out of the trace: " << total.num_dropped_ << '\n';
+		}
+	}
+
+	namespace multiplex //games run as coroutines that suspend for the decisions of evaluated seats, so many can be in flight on one thread
+	{
+		template <typename Configuration>
+		struct decision //asked by a suspended game, answered by writing action_ before it is resumed
+		{
+			const game_state<Configuration>* state_;
+			const belief<Configuration>* beliefs_;
+			typename Configuration::template actions<std::variant> action_{};
+		};
+
+		template <typename Configuration>
+		class game_task //returned by game::play, which starts suspended. resume() runs the game until it waits on a decision or ends
+		{
+		public:
+
+			struct promise_type
+			{
+				decision<Configuration>* pending_ = nullptr;
+				std::exception_ptr error_;
+
+				game_task get_return_object() { return game_task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+				std::suspend_always initial_suspend() noexcept { return {}; }
+				std::suspend_always final_suspend() noexcept { return {}; }
+				void return_void() {}
+				void unhandled_exception() { error_ = std::current_exception(); }
+			};
+
+			game_task(game_task&& other) noexcept : handle_(std::exchange(other.handle_, {}))
+			{
+			}
+
+			game_task& operator=(game_task&& other) noexcept
+			{
+				if (this != &other)
+				{
+					if (handle_) handle_.destroy();
+					handle_ = std::exchange(other.handle_, {});
+				}
+				return *this;
+			}
+
+			~game_task()
+			{
+				if (handle_) handle_.destroy();
+			}
+
+			bool done() const
+			{
+				return handle_.done();
+			}
+
+			decision<Configuration>* pending() const //what the game waits on, null when it has not started or has ended
+			{
+				return handle_.promise().pending_;
+			}
+
+			void resume()
+			{
+				handle_.promise().pending_ = nullptr;
+				handle_.resume();
+				if (handle_.promise().error_) std::rethrow_exception(handle_.promise().error_);
+			}
+
+		private:
+
+			explicit game_task(std::coroutine_handle<promise_type> handle) : handle_(handle)
+			{
+			}
+
+			std::coroutine_handle<promise_type> handle_;
+		};
+
+		template <typename Configuration>
+		struct decide //co_await decide{ { &state, &beliefs } } gives the action written to the decision while the game was suspended
+		{
+			decision<Configuration> decision_;
+
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<typename game_task<Configuration>::promise_type> handle) noexcept { handle.promise().pending_ = &decision_; }
+			auto await_resume() const { return decision_.action_; }
+		};
+	}
+
+	template<typename Configuration = hanabi::configuration::default_t, typename History = history::full<Configuration>>
+	class game
+	{
+	public:
+
+		using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+		template <typename Gen>
+		void init(Gen& gen)
+		{
+			history_.reset(deal(gen));
+			belief_.reset(history_.current());
+		}
+
+		template <typename Gen>
+		static game_state<Configuration> deal(Gen& gen) //shuffled deck with the opening hands dealt out
+		{
+			auto initial_card_list = std::apply([] <typename... Colors, typename... Ranks, size_t... Freqs> (card_frequency<Colors, Ranks, Freqs>&&...)
+			{
+				return std::apply([] <typename... CardColors, typename... CardRanks> (card_info<CardColors, CardRanks>&&...)
+				{
+					return std::array{ card_state<Configuration>::template identity_of<CardColors, CardRanks>()... };
+				}, std::tuple_cat(typename card_frequency<Colors, Ranks, Freqs>::tuple{}...));
+			}, typename configuration_t::card_frequencies{});
+
+			std::shuffle(initial_card_list.begin(), initial_card_list.end(), gen);
+
+			return deal_from(initial_card_list);
+		}
+
+		static game_state<Configuration> deal_from(std::span<const std::uint8_t, configuration_t::deck_size> identities) //the deck in draw order, as card identities
+		{
+			game_state<Configuration> init_state{};
+
+			std::transform(identities.begin(), identities.end(), init_state.deck_.cards_.begin(), [](std::uint8_t identity)
+				{
+					return card_state<Configuration>{ identity, card_state<Configuration>::location_code(location::draw_pile{}), {} };
+				});
+
+
+			init_state.fireworks_ = {};
+			init_state.num_available_hints_ = configuration_t::max_num_hints;
+			init_state.num_mistakes_ = 0;
+			init_state.player_turn_ = 0;
+
+			init_state.hand_sizes_ = {};
+
+			for (size_t player = 0, next_card = 0; player < configuration_t::num_players; ++player)
+			{
+				for (size_t i = 0; i < configuration_t::hand_size; ++i)
+				{
+					init_state.add_to_hand(static_cast<int>(player), static_cast<int>(next_card++));
+				}
+			}
+
+			init_state.next_card_to_draw_ = static_cast<int>(configuration_t::hand_size * configuration_t::num_players);
+			init_state.last_player_to_play_ = std::nullopt;
+			init_state.last_player_has_played_ = false;
+			init_state.hash_ = init_state.compute_hash();
+
+			return init_state;
+		}
+
+		static constexpr bool game_is_over(const game_state<Configuration>& state)
+		{
+			return state.is_over();
+		}
+
+		static constexpr int score_of(const game_state<Configuration>& state)
+		{
+			return state.score();
+		}
+
+		static void display_hand_of(std::ostream& stream, const game_state<Configuration>& state_to_display, int player)
+		{
+			stream << "player " << player << "s hand: ";
+
+			for (const auto card_in_hand : state_to_display.hand_of(player))
+			{
+				state_to_display.deck_.cards_[card_in_hand].get_card().display_card(stream) << ' ';
+			}
+
+			stream << '\n';
+		}
+
+		static void display_played_cards(std::ostream& stream, const game_state<Configuration>& state_to_display)
+		{
+			stream << "played: ";
+
+			for (size_t color = 0; color < state_to_display.fireworks_.size(); ++color)
+			{
+				if (state_to_display.fireworks_[color] > 0)
+				{
+					const auto identity = static_cast<std::uint8_t>(color * configuration_t::num_ranks + state_to_display.fireworks_[color] - 1);
+					card_state<Configuration>::card_of(identity).display_card(stream) << ' ';
+				}
+				else
+				{
+					stream << "  ";
+				}
+			}
+
+			stream << '\n';
+		}
+
+		static void display_mistakes_and_hints(std::ostream& stream, const game_state<Configuration>& state_to_display)
+		{
+			stream << "num available hints: " << state_to_display.num_available_hints_ << ", num mistakes made: " << state_to_display.num_mistakes_ << '\n';
+		}
+
+		static void display_discard(std::ostream& stream, const game_state<Configuration>& state_to_display)
+		{
+
+		}
+
+		static void display_state(std::ostream& stream, const game_state<Configuration>& state_to_display)
+		{
+			stream << "-------------\n";
+			stream << "player " << state_to_display.player_turn_ << "s turn\n";
+			for (int partner = game_state<Configuration>::next_player(state_to_display.player_turn_); partner != state_to_display.player_turn_; partner = game_state<Configuration>::next_player(partner))
+			{
+				display_hand_of(stream, state_to_display, partner);
+			}
+
+			display_played_cards(stream, state_to_display);
+			display_mistakes_and_hints(stream, state_to_display);
+			display_discard(stream, state_to_display);
+		}
+
+		template <typename... Controllers, typename Gen>
+		void run(Gen& gen) //headless
+		{
+			sink::null headless;
+			run<Controllers...>(gen, headless);
+		}
+
+		template <typename... Controllers, typename Gen, typename Sink>
+		void run(Gen& gen, Sink& out, const controller::options& chosen = {}) //rng for seeding, out is a sink:: type
+		{
+			if constexpr (sizeof...(Controllers) == 0) //a random player in the first seat and humans in the others
+			{
+				return [&] <size_t... Seats> (std::index_sequence<Seats...>)
+				{
+					return run<std::conditional_t<Seats == 0, controller::random_ai<Configuration>, controller::human<Configuration>>...>(gen, out, chosen);
+				}(std::make_index_sequence<configuration_t::num_players>{});
+			}
+			else
+			{
+				static_assert(sizeof...(Controllers) == configuration_t::num_players, "Every seat needs a controller.");
+
+				run_with(std::tuple<controller::player_controller<controller::with_generator_t<Controllers, Gen>>...>{ controller::make_player_controller<controller::with_generator_t<Controllers, Gen>>(gen, chosen)... }, out);
+			}
+		}
+
+		//run as a coroutine, headless: turns of controller::evaluated seats suspend the game until a multiplex:: scheduler answers them,
+		//the other seats are asked in place. gen and this game must outlive the task
+		template <typename... Controllers, typename Gen>
+		multiplex::game_task<Configuration> play(Gen& gen, controller::options chosen = {}) //chosen by value, the coroutine keeps its own copy
+		{
+			static_assert(sizeof...(Controllers) == configuration_t::num_players, "Every seat needs a controller.");
+
+			constexpr std::array<bool, sizeof...(Controllers)> is_evaluated = { std::is_same_v<Controllers, controller::evaluated<Configuration>>... };
+
+			auto player_controllers = std::tuple<controller::player_controller<controller::with_generator_t<Controllers, Gen>>...>{ controller::make_player_controller<controller::with_generator_t<Controllers, Gen>>(gen, chosen)... };
+			sink::null headless;
+
+			while (!game_is_over(history_.current()))
+			{
+				const auto& state = history_.current();
+
+				const auto pc_action = is_evaluated[state.player_turn_]
+					? co_await multiplex::decide<Configuration>{ { &state, &belief_ } }
+					: controller::choose_player_controller_action(state, belief_, player_controllers, headless);
+
+				take_turn(pc_action, headless);
+			}
+
+			finish(headless);
+		}
+
+		constexpr std::optional<int> final_score () const
+		{
+			return final_score_;
+		}
+
+		const History& get_history() const
+		{
+			return history_;
+		}
+
+		const belief<Configuration>& get_belief() const //of the current state
+		{
+			return belief_;
+		}
+	private:
+
+		template <typename... Controllers, typename Sink>
+		void run_with(std::tuple<controller::player_controller<Controllers>...> player_controllers, Sink& out)
+		{
+			if constexpr (Sink::enabled)
+			{
+				out.stream() << "start: \n";
+				for (size_t player = 0; player < configuration_t::num_players; ++player) display_hand_of(out.stream(), history_.current(), static_cast<int>(player));
+				out.stream() << "\n\n";
+			}
+
+			while (!game_is_over(history_.current()))
+			{
+				const auto& state = history_.current();
+				const auto turn = history_.num_turns();
+
+				if constexpr (Sink::enabled)
+				{
+					const instrument::span displaying(instrument::phase::display, turn);
+					display_state(out.stream(), state);
+					out.flush();
+				}
+
+				auto pc_action = [&]()
+				{
+					const instrument::span deciding(instrument::phase::decide, turn);
+					return controller::choose_player_controller_action(state, belief_, player_controllers, out);
+				}();
+
+				take_turn(pc_action, out);
+			}
+
+			finish(out);
+		}
+
+		template <typename Sink>
+		void take_turn(const typename Configuration::template actions<std::variant>& pc_action, Sink& out)
+		{
+			const auto& state = history_.current();
+			const auto turn = history_.num_turns();
+
+			std::visit([&](const auto& action)
+			{
+				if constexpr (Sink::enabled)
+				{
+					const instrument::span displaying(instrument::phase::display, turn);
+					action.display_action(out.stream(), state);
+					out.flush();
+				}
+
+				{
+					const instrument::span observing(instrument::phase::observe, turn);
+					belief_.observe(state, action);
+				}
+
+				auto next_state = [&]()
+				{
+					instrument::span performing(instrument::phase::perform, turn);
+					performing.set_action(instrument::kind_of<Configuration>(action));
+					return action.perform(state);
+				}();
+
+				history_.push(next_state, action);
+			}, pc_action);
+		}
+
+		template <typename Sink>
+		void finish(Sink& out)
+		{
+			if constexpr (Sink::enabled)
+			{
+				display_state(out.stream(), history_.current());
+				out.flush();
+			}
+
+			final_score_ = score_of(history_.current());
+		}
+
+		History history_;
+		belief<Configuration> belief_;
+		std::optional<int> final_score_;
+	};
+
+	namespace record //finished games on disk, read back through a memory map
+	{
+		//a file is a header, the records back to back, then an index of where each record starts. all integers are little endian.
+		//header: "HNBR", u16 version, u8 num_players, hand_size, num_colors, num_ranks, deck_size, one unused byte, u32 unused, u64 num_records, u64 index offset
+		//record: u16 num_turns, u8 score, the deck in draw order as deck_size card identities, then num_turns action_code bytes
+
+		inline constexpr std::array<char, 4> magic = { 'H', 'N', 'B', 'R' };
+		inline constexpr std::uint16_t version = 1;
+		inline constexpr size_t header_size = 32;
+		inline constexpr size_t record_header_size = 3;
+
+		template <typename Configuration>
+		constexpr std::array<std::uint8_t, 6> table_layout() //the configuration a file was written with
+		{
+			using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+			return { static_cast<std::uint8_t>(configuration_t::num_players), static_cast<std::uint8_t>(configuration_t::hand_size),
+				static_cast<std::uint8_t>(configuration_t::num_colors), static_cast<std::uint8_t>(configuration_t::num_ranks),
+				static_cast<std::uint8_t>(configuration_t::deck_size), 0 };
+		}
+
+		template <typename Unsigned>
+		void put(std::ostream& stream, Unsigned value)
+		{
+			std::array<char, sizeof(Unsigned)> bytes;
+			for (auto& byte : bytes)
+			{
+				byte = static_cast<char>(value & 0xFF);
+				value = static_cast<Unsigned>(value >> 8);
+			}
+			stream.write(bytes.data(), bytes.size());
+		}
+
+		template <typename Unsigned>
+		Unsigned get(const std::uint8_t* from) noexcept
+		{
+			Unsigned value = 0;
+			for (size_t byte = sizeof(Unsigned); byte-- > 0;) value = static_cast<Unsigned>((value << 8) | from[byte]);
+			return value;
+		}
+
+		template <typename Configuration>
+		class writer
+		{
+		public:
+
+			using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+			explicit writer(const std::string& path) : file_(path, std::ios::binary | std::ios::trunc)
+			{
+				if (!file_) throw std::runtime_error("Could not open " + path + " for writing.");
+
+				write_header();
+			}
+
+			writer(const writer&) = delete;
+			writer& operator=(const writer&) = delete;
+
+			~writer()
+			{
+				if (file_.is_open()) close();
+			}
+
+			void write(const game_state<Configuration>& initial_state, std::span<const std::uint8_t> action_codes, int score) //safe to call from several threads
+			{
+				if (action_codes.size() > std::numeric_limits<std::uint16_t>::max()) throw std::runtime_error("Game is too long to record.");
+
+				std::array<char, configuration_t::deck_size> deck;
+				std::transform(initial_state.deck_.cards_.begin(), initial_state.deck_.cards_.end(), deck.begin(), [](const auto& card_in_deck) { return static_cast<char>(card_in_deck.identity_); });
+
+				std::scoped_lock lock(mutex_);
+
+				offsets_.push_back(static_cast<std::uint64_t>(file_.tellp()));
+				put(file_, static_cast<std::uint16_t>(action_codes.size()));
+				put(file_, static_cast<std::uint8_t>(score));
+				file_.write(deck.data(), deck.size());
+				file_.write(reinterpret_cast<const char*>(action_codes.data()), action_codes.size());
+			}
+
+			template <typename History>
+			void write(const History& finished) //any history with state_at, code_at and num_turns
+			{
+				std::vector<std::uint8_t> codes;
+				codes.reserve(finished.num_turns());
+
+				for (size_t turn = 0; turn < finished.num_turns(); ++turn) codes.push_back(finished.code_at(turn));
+
+				write(finished.state_at(0), codes, finished.current().score());
+			}
+
+			void close() //writes the index and the final header
+			{
+				std::scoped_lock lock(mutex_);
+
+				const auto index_offset = static_cast<std::uint64_t>(file_.tellp());
+				for (const auto offset : offsets_) put(file_, offset);
+
+				file_.seekp(16);
+				put(file_, static_cast<std::uint64_t>(offsets_.size()));
+				put(file_, index_offset);
+				file_.close();
+			}
+
+		private:
+
+			void write_header()
+			{
+				constexpr auto layout = table_layout<Configuration>();
+
+				file_.write(magic.data(), magic.size());
+				put(file_, version);
+				file_.write(reinterpret_cast<const char*>(layout.data()), layout.size());
+				put(file_, std::uint32_t{ 0 });
+				put(file_, std::uint64_t{ 0 }); //filled in by close
+				put(file_, std::uint64_t{ 0 });
+			}
+
+			std::ofstream file_;
+			std::vector<std::uint64_t> offsets_;
+			std::mutex mutex_;
+		};
+
+		class mapped_file //read only view of a whole file
+		{
+		public:
+
+			explicit mapped_file(const std::string& path)
+			{
+#if defined(_WIN32)
+				file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (file_ == INVALID_HANDLE_VALUE) throw std::runtime_error("Could not open " + path + ".");
+
+				LARGE_INTEGER file_size;
+				GetFileSizeEx(file_, &file_size);
+				size_ = static_cast<size_t>(file_size.QuadPart);
+
+				mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping_ != nullptr) data_ = static_cast<const std::uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+#else
+				const int descriptor = ::open(path.c_str(), O_RDONLY);
+				if (descriptor < 0) throw std::runtime_error("Could not open " + path + ".");
+
+				struct stat file_status;
+				if (::fstat(descriptor, &file_status) != 0)
+				{
+					::close(descriptor);
+					throw std::runtime_error("Could not read the size of " + path + ".");
+				}
+				size_ = static_cast<size_t>(file_status.st_size);
+
+				if (void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor, 0); mapped != MAP_FAILED)
+				{
+					data_ = static_cast<const std::uint8_t*>(mapped);
+					::madvise(mapped, size_, MADV_SEQUENTIAL);
+				}
+
+				::close(descriptor);
+#endif
+				if (data_ == nullptr)
+				{
+					unmap();
+					throw std::runtime_error("Could not map " + path + ".");
+				}
+			}
+
+			mapped_file(const mapped_file&) = delete;
+			mapped_file& operator=(const mapped_file&) = delete;
+
+			~mapped_file()
+			{
+				unmap();
+			}
+
+			const std::uint8_t* data() const noexcept { return data_; }
+			size_t size() const noexcept { return size_; }
+
+		private:
+
+			void unmap() noexcept
+			{
+#if defined(_WIN32)
+				if (data_ != nullptr) UnmapViewOfFile(data_);
+				if (mapping_ != nullptr) CloseHandle(mapping_);
+				if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#else
+				if (data_ != nullptr) ::munmap(const_cast<std::uint8_t*>(data_), size_);
+#endif
+			}
+
+#if defined(_WIN32)
+			HANDLE file_ = INVALID_HANDLE_VALUE;
+			HANDLE mapping_ = nullptr;
+#endif
+			const std::uint8_t* data_ = nullptr;
+			size_t size_ = 0;
+		};
+
+		template <typename Configuration>
+		struct game_record //points into the mapped file
+		{
+			using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+			std::span<const std::uint8_t, configuration_t::deck_size> deck_;
+			std::span<const std::uint8_t> action_codes_;
+			int score_;
+
+			game_state<Configuration> initial_state() const
+			{
+				return game<Configuration>::deal_from(deck_);
+			}
+
+			game_state<Configuration> final_state() const //replays every action
+			{
+				auto state = initial_state();
+
+				for (const auto code : action_codes_) action_code<Configuration>::apply(state, code);
+
+				return state;
+			}
+		};
+
+		template <typename Configuration>
+		class reader
+		{
+		public:
+
+			using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+			explicit reader(const std::string& path) : file_(path), path_(path)
+			{
+				const auto* bytes = file_.data();
+				constexpr auto layout = table_layout<Configuration>();
+
+				if (file_.size() < header_size || !std::equal(magic.begin(), magic.end(), bytes) || get<std::uint16_t>(bytes + 4) != version)
+				{
+					throw std::runtime_error(path + " is not a game record file.");
+				}
+
+				if (!std::equal(layout.begin(), layout.end(), bytes + 6)) throw std::runtime_error(path + " was recorded with a different configuration.");
+
+				num_records_ = get<std::uint64_t>(bytes + 16);
+				index_offset_ = get<std::uint64_t>(bytes + 24);
+
+				if (index_offset_ < header_size || index_offset_ > file_.size() || num_records_ > (file_.size() - index_offset_) / sizeof(std::uint64_t))
+				{
+					throw std::runtime_error(path + " was not closed properly.");
+				}
+			}
+
+			size_t size() const noexcept { return num_records_; }
+
+			game_record<Configuration> operator[](size_t i) const //throws for an index entry that does not point at a whole record
+			{
+				if (i >= num_records_) throw std::out_of_range("Record " + std::to_string(i) + " is past the last of " + path_ + ".");
+
+				return record_at(get<std::uint64_t>(file_.data() + index_offset_ + i * sizeof(std::uint64_t)));
+			}
+
+			class iterator //walks the records in file order, without the index. throws on a record that runs past the others
+			{
+			public:
+
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = game_record<Configuration>;
+				using difference_type = std::ptrdiff_t;
+
+				iterator() = default;
+				iterator(const reader* records, std::uint64_t offset) noexcept : records_(records), offset_(offset) {}
+
+				value_type operator*() const { return records_->record_at(offset_); }
+
+				iterator& operator++()
+				{
+					offset_ = records_->record_end(offset_);
+					return *this;
+				}
+
+				iterator operator++(int)
+				{
+					auto previous = *this;
+					++*this;
+					return previous;
+				}
+
+				bool operator==(const iterator&) const = default;
+
+			private:
+
+				const reader* records_ = nullptr;
+				std::uint64_t offset_ = 0;
+			};
+
+			iterator begin() const noexcept { return iterator(this, header_size); }
+			iterator end() const noexcept { return iterator(this, index_offset_); }
+
+		private:
+
+			std::uint64_t record_end(std::uint64_t offset) const //where the record at offset ends, checked to lie within [header_size, index_offset_)
+			{
+				constexpr auto fixed_size = record_header_size + configuration_t::deck_size;
+
+				if (offset < header_size || offset >= index_offset_ || index_offset_ - offset < fixed_size)
+				{
+					throw std::runtime_error(path_ + " is corrupt, a record at offset " + std::to_string(offset) + " is not within the records.");
+				}
+
+				const auto end = offset + fixed_size + get<std::uint16_t>(file_.data() + offset);
+				if (end > index_offset_) throw std::runtime_error(path_ + " is corrupt, the record at offset " + std::to_string(offset) + " runs past the records.");
+
+				return end;
+			}
+
+			game_record<Configuration> record_at(std::uint64_t offset) const
+			{
+				record_end(offset);
+
+				const auto* at = file_.data() + offset;
+				const auto num_turns = get<std::uint16_t>(at);
+				const auto* deck = at + record_header_size;
+
+				return { std::span<const std::uint8_t, configuration_t::deck_size>(deck, configuration_t::deck_size), { deck + configuration_t::deck_size, num_turns }, at[2] };
+			}
+
+			mapped_file file_;
+			std::string path_;
+			std::uint64_t num_records_ = 0;
+			std::uint64_t index_offset_ = 0;
+		};
+	}
+
+	namespace batch
+	{
+		template <typename Configuration>
+		struct statistics
+		{
+			using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+			std::uint64_t num_games_ = 0;
+			double seconds_ = 0.0;
+			std::array<std::uint64_t, configuration_t::max_score + 1> score_histogram_{};
+
+			statistics& operator+=(const statistics& other)
+			{
+				num_games_ += other.num_games_;
+				std::transform(score_histogram_.begin(), score_histogram_.end(), other.score_histogram_.begin(), score_histogram_.begin(), std::plus<>{});
+				return *this;
+			}
+
+			double games_per_second() const
+			{
+				return seconds_ > 0.0 ? num_games_ / seconds_ : 0.0;
+			}
+
+			double mean_score() const
+			{
+				std::uint64_t total = 0;
+				for (size_t score = 0; score < score_histogram_.size(); ++score) total += score * score_histogram_[score];
+				return num_games_ > 0 ? static_cast<double>(total) / num_games_ : 0.0;
+			}
+
+			std::ostream& display_statistics(std::ostream& stream) const
+			{
+				stream << "games played: " << num_games_ << " in " << seconds_ << "s (" << games_per_second() << " games/s)\n";
+				stream << "mean score: " << mean_score() << '\n';
+
+				for (size_t score = 0; score < score_histogram_.size(); ++score)
+				{
+					if (score_histogram_[score] == 0) continue;
+					stream << "score " << score << ":\t" << score_histogram_[score] << "\t(" << 100.0 * score_histogram_[score] / num_games_ << "%)\n";
+				}
+
+				return stream;
+			}
+		};
+
+		//games are split into fixed size streams, each with its own generator seeded from (base_seed, stream),
+		//so the results for a base seed do not depend on how many threads pick up the streams
+		inline constexpr std::uint64_t games_per_stream = 4096;
+
+		inline std::mt19937 stream_generator(std::uint32_t base_seed, std::uint64_t stream)
+		{
+			std::seed_seq seq{ base_seed, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32) };
+			return std::mt19937(seq);
+		}
+
+		enum class seeding
+		{
+			streams, //a std::mt19937 per stream from stream_generator, its games dealt one after another
+			per_game, //an rng::for_game generator per game, so game i can be played again alone with play_game
+		};
+
+		template <typename Configuration, typename... Controllers>
+		game<Configuration, history::compact<Configuration>> play_game(std::uint32_t base_seed, std::uint64_t game_index, const controller::options& chosen = {}) //game game_index of a seeding::per_game run
+		{
+			auto gen = rng::for_game(base_seed, game_index);
+			sink::null headless;
+
+			game<Configuration, history::compact<Configuration>> headless_game;
+			headless_game.init(gen);
+			headless_game.template run<Controllers...>(gen, headless, chosen);
+
+			return headless_game;
+		}
+
+		template <typename Configuration, typename... Controllers>
+		statistics<Configuration> play_stream(std::uint32_t base_seed, std::uint64_t stream, std::uint64_t num_games, record::writer<Configuration>* recorder = nullptr, seeding seeded = seeding::streams, const controller::options& chosen = {})
+		{
+			statistics<Configuration> stats;
+			stats.num_games_ = num_games;
+
+			const auto tally = [&](const auto& headless_game)
+			{
+				++stats.score_histogram_[headless_game.final_score().value()];
+				if (recorder != nullptr) recorder->write(headless_game.get_history());
+			};
+
+			if (seeded == seeding::per_game)
+			{
+				for (std::uint64_t i = 0; i < num_games; ++i) tally(play_game<Configuration, Controllers...>(base_seed, stream * games_per_stream + i, chosen));
+				return stats;
+			}
+
+			auto gen = stream_generator(base_seed, stream);
+			sink::null headless;
+
+			for (std::uint64_t i = 0; i < num_games; ++i)
+			{
+				game<Configuration, history::compact<Configuration>> headless_game;
+				headless_game.init(gen);
+				headless_game.template run<Controllers...>(gen, headless, chosen);
+
+				tally(headless_game);
+			}
+
+			return stats;
+		}
+
+		template <typename Configuration, typename PlayStream> //play_stream(stream, num_games) -> statistics<Configuration>
+		statistics<Configuration> run_streams(std::uint64_t num_games, unsigned num_threads, PlayStream&& play_stream)
+		{
+			const std::uint64_t num_streams = (num_games + games_per_stream - 1) / games_per_stream;
+			std::atomic<std::uint64_t> next_stream = 0;
+			std::vector<statistics<Configuration>> per_worker(std::max(1u, num_threads));
+
+			const auto start = std::chrono::steady_clock::now();
+			{
+				std::vector<std::jthread> workers;
+
+				for (auto& worker_stats : per_worker)
+				{
+					workers.emplace_back([&]()
+					{
+						for (auto stream = next_stream++; stream < num_streams; stream = next_stream++)
+						{
+							const auto games_this_stream = std::min(games_per_stream, num_games - stream * games_per_stream);
+							worker_stats += play_stream(stream, games_this_stream);
+						}
+					});
+				}
+			}
+			const auto end = std::chrono::steady_clock::now();
+
+			statistics<Configuration> total;
+			for (const auto& worker_stats : per_worker) total += worker_stats;
+			total.seconds_ = std::chrono::duration<double>(end - start).count();
+
+			return total;
+		}
+
+		template <typename Configuration, typename... Controllers>
+		statistics<Configuration> run(std::uint64_t num_games, std::uint32_t base_seed, unsigned num_threads, record::writer<Configuration>* recorder = nullptr, seeding seeded = seeding::streams, const controller::options& chosen = {})
+		{
+			return run_streams<Configuration>(num_games, num_threads, [base_seed, recorder, seeded, &chosen](std::uint64_t stream, std::uint64_t games_this_stream)
+				{
+					return play_stream<Configuration, Controllers...>(base_seed, stream, games_this_stream, recorder, seeded, chosen);
+				});
+		}
+
+		template <typename Configuration, typename Controller> //the same controller in every seat
+		statistics<Configuration> run_self_play(std::uint64_t num_games, std::uint32_t base_seed, unsigned num_threads, record::writer<Configuration>* recorder = nullptr, seeding seeded = seeding::streams, const controller::options& chosen = {})
+		{
+			return [&] <size_t... Seats> (std::index_sequence<Seats...>)
+			{
+				return run<Configuration, std::tuple_element_t<Seats * 0, std::tuple<Controller>>...>(num_games, base_seed, num_threads, recorder, seeded, chosen);
+			}(std::make_index_sequence<configuration::configuration_traits<Configuration>::num_players>{});
+		}
+	}
+
+	namespace multiplex
+	{
+		template <typename Configuration>
+		struct rule_based_evaluator //a local stand-in for a model server, answers a whole batch with controller::rule_based
+		{
+			void operator()(std::span<decision<Configuration>> batched) const
+			{
+				for (auto& pending : batched) pending.action_ = controller::rule_based<Configuration>::choose(*pending.state_, *pending.beliefs_);
+			}
+		};
+
+		//games dealt as batch::seeding::per_game deals them, games_in_flight at a time on each worker. a worker resumes each of its games until
+		//it waits on a decision or ends, replacing ended games with the next game index, then hands every waiting decision to
+		//evaluator(std::span<decision<Configuration>>) at once. the evaluator is called from all workers together.
+		//with an evaluator that answers the same state the same way, the results depend on base_seed alone
+		template <typename Configuration, typename... Controllers, typename Evaluator>
+		batch::statistics<Configuration> run(std::uint64_t num_games, std::uint32_t base_seed, unsigned num_threads, Evaluator& evaluator, size_t games_in_flight = 256, record::writer<Configuration>* recorder = nullptr)
+		{
+			struct slot //a game in flight, never moved while its coroutine refers to it
+			{
+				rng::xoshiro256ss gen_;
+				game<Configuration, history::compact<Configuration>> game_;
+				std::optional<game_task<Configuration>> task_;
+			};
+
+			std::atomic<std::uint64_t> next_game = 0;
+			std::vector<batch::statistics<Configuration>> per_worker(std::max(1u, num_threads));
+
+			const auto start = std::chrono::steady_clock::now();
+			{
+				std::vector<std::jthread> workers;
+
+				for (auto& worker_stats : per_worker)
+				{
+					workers.emplace_back([&]()
+					{
+						std::vector<slot> slots(std::max<size_t>(games_in_flight, 1));
+						std::vector<slot*> waiting;
+						std::vector<decision<Configuration>> batched;
+
+						const auto deal_next = [&](slot& free)
+						{
+							const auto game_index = next_game++;
+							if (game_index >= num_games)
+							{
+								free.task_.reset();
+								return;
+							}
+
+							free.gen_ = rng::for_game(base_seed, game_index);
+							free.game_.init(free.gen_);
+							free.task_.emplace(free.game_.template play<Controllers...>(free.gen_));
+						};
+
+						for (auto& free : slots) deal_next(free);
+
+						while (true)
+						{
+							waiting.clear();
+
+							for (auto& active : slots)
+							{
+								while (active.task_.has_value())
+								{
+									active.task_->resume();
+									if (!active.task_->done()) break;
+
+									++worker_stats.num_games_;
+									++worker_stats.score_histogram_[active.game_.final_score().value()];
+									if (recorder != nullptr) recorder->write(active.game_.get_history());
+
+									deal_next(active);
+								}
+
+								if (active.task_.has_value()) waiting.push_back(&active);
+							}
+
+							if (waiting.empty()) break;
+
+							batched.clear();
+							for (const auto* active : waiting) batched.push_back(*active->task_->pending());
+
+							evaluator(std::span<decision<Configuration>>(batched));
+
+							for (size_t i = 0; i < waiting.size(); ++i) waiting[i]->task_->pending()->action_ = batched[i].action_;
+						}
+					});
+				}
+			}
+			const auto end = std::chrono::steady_clock::now();
+
+			batch::statistics<Configuration> total;
+			for (const auto& worker_stats : per_worker) total += worker_stats;
+			total.seconds_ = std::chrono::duration<double>(end - start).count();
+
+			return total;
+		}
+
+		template <typename Configuration, typename Evaluator> //every seat evaluated
+		batch::statistics<Configuration> run_evaluated(std::uint64_t num_games, std::uint32_t base_seed, unsigned num_threads, Evaluator& evaluator, size_t games_in_flight = 256, record::writer<Configuration>* recorder = nullptr)
+		{
+			return [&] <size_t... Seats> (std::index_sequence<Seats...>)
+			{
+				return run<Configuration, std::tuple_element_t<Seats * 0, std::tuple<controller::evaluated<Configuration>>>...>(num_games, base_seed, num_threads, evaluator, games_in_flight, recorder);
+			}(std::make_index_sequence<configuration::configuration_traits<Configuration>::num_players>{});
+		}
+	}
+
+	namespace tournament //controllers compared two at a time on the same deals, each pairing stopped once the gap between their mean scores is known closely enough
+	{
+		struct settings
+		{
+			std::uint32_t base_seed_ = 0;
+			unsigned num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+			std::uint64_t max_games_ = 20000; //per pairing
+			std::uint64_t min_games_ = 1000; //played before a pairing may stop early
+			std::uint64_t games_per_block_ = 250; //the unit of work, and how often stopping is checked
+			double half_width_ = 0.1; //a pairing stops once the confidence interval of its mean score difference is within +-half_width_
+			double z_ = 1.96; //95% interval
+			std::vector<size_t> entrants_; //indices into the controllers, every one of them when empty
+			controller::options controllers_; //for every game, games run num_threads_ at a time
+		};
+
+		struct result
+		{
+			size_t first_; //indices into the controllers
+			size_t second_;
+			std::uint64_t num_games_ = 0;
+			double mean_first_ = 0.0;
+			double mean_second_ = 0.0;
+			double mean_difference_ = 0.0; //first minus second
+			double half_width_ = 0.0;
+			bool stopped_early_ = false;
+		};
+
+		template <typename Task>
+		class work_stealing_queues //a deque per worker. the owner takes from the front, the others steal from the back once their own runs dry
+		{
+		public:
+
+			explicit work_stealing_queues(size_t num_workers) : queues_(std::max<size_t>(num_workers, 1))
+			{
+			}
+
+			void push(size_t worker, Task task)
+			{
+				auto& owned = queues_[worker % queues_.size()];
+				std::scoped_lock lock(owned.mutex_);
+				owned.tasks_.push_back(std::move(task));
+			}
+
+			std::optional<Task> take(size_t worker) //nothing once every queue is empty, tasks never add more
+			{
+				for (size_t offset = 0; offset < queues_.size(); ++offset)
+				{
+					auto& victim = queues_[(worker + offset) % queues_.size()];
+					std::scoped_lock lock(victim.mutex_);
+					if (victim.tasks_.empty()) continue;
+
+					auto& end = offset == 0 ? victim.tasks_.front() : victim.tasks_.back();
+					Task taken = std::move(end);
+					if (offset == 0) victim.tasks_.pop_front();
+					else victim.tasks_.pop_back();
+					return taken;
+				}
+
+				return std::nullopt;
+			}
+
+		private:
+
+			struct queue
+			{
+				std::mutex mutex_;
+				std::deque<Task> tasks_;
+			};
+
+			std::vector<queue> queues_;
+		};
+
+		template <typename Configuration, typename Controller>
+		int self_play_score(std::uint32_t base_seed, std::uint64_t game_index, const controller::options& chosen) //game game_index with the controller in every seat, dealt as batch::play_game deals it
+		{
+			return [&] <size_t... Seats> (std::index_sequence<Seats...>)
+			{
+				return batch::play_game<Configuration, std::tuple_element_t<Seats * 0, std::tuple<Controller>>...>(base_seed, game_index, chosen).final_score().value();
+			}(std::make_index_sequence<configuration::configuration_traits<Configuration>::num_players>{});
+		}
+
+		//every pairing of entrants plays game i of the shared seed set once per side, each side in every seat, so the difference of the two scores
+		//leaves out most of the luck of the deal. blocks of games are spread over work stealing queues, and a pairing's blocks are added to its
+		//totals in order, so where it stops, and so every result, depends on the settings alone and not on the number of threads
+		template <typename Configuration, typename... Controllers>
+		std::vector<result> run(const settings& chosen)
+		{
+			using play_t = int (*)(std::uint32_t, std::uint64_t, const controller::options&);
+			static constexpr std::array<play_t, sizeof...(Controllers)> self_play = { &self_play_score<Configuration, Controllers>... };
+
+			struct block_sums
+			{
+				std::uint64_t num_games_ = 0;
+				double first_ = 0.0;
+				double second_ = 0.0;
+				double difference_ = 0.0;
+				double difference_squared_ = 0.0;
+			};
+
+			struct pairing
+			{
+				std::mutex mutex_;
+				std::vector<std::optional<block_sums>> blocks_;
+				size_t num_added_ = 0;
+				block_sums total_;
+				std::atomic<bool> decided_ = false;
+				result result_;
+			};
+
+			struct task
+			{
+				size_t pairing_;
+				size_t block_;
+			};
+
+			struct known_scores //of one controller, a block of games at a time so pairings that stop early never allocate the rest
+			{
+				std::mutex mutex_;
+				std::vector<std::unique_ptr<std::atomic<std::uint8_t>[]>> blocks_;
+			};
+
+			auto entrants = chosen.entrants_;
+			if (entrants.empty())
+			{
+				entrants.resize(sizeof...(Controllers));
+				std::iota(entrants.begin(), entrants.end(), size_t{ 0 });
+			}
+
+			std::vector<std::pair<size_t, size_t>> pairs;
+			for (size_t i = 0; i < entrants.size(); ++i)
+			{
+				for (size_t j = i + 1; j < entrants.size(); ++j) pairs.emplace_back(entrants[i], entrants[j]);
+			}
+
+			const auto games_per_block = std::max<std::uint64_t>(chosen.games_per_block_, 1);
+			const auto num_blocks = static_cast<size_t>((chosen.max_games_ + games_per_block - 1) / games_per_block);
+			const auto num_workers = std::max(1u, chosen.num_threads_);
+
+			std::vector<pairing> pairings(pairs.size());
+			for (auto& played : pairings) played.blocks_.resize(num_blocks);
+
+			work_stealing_queues<task> queues(num_workers);
+			size_t next_queue = 0;
+
+			for (size_t block = 0; block < num_blocks; ++block) //early blocks first everywhere, the ones most likely to be needed
+			{
+				for (size_t p = 0; p < pairs.size(); ++p) queues.push(next_queue++, { p, block });
+			}
+
+			//each controller plays game i the same way in every pairing, so its scores are kept. 0 is not yet played, score + 1 otherwise
+			std::vector<known_scores> known(sizeof...(Controllers));
+			for (auto& scores : known) scores.blocks_.resize(num_blocks);
+
+			const auto known_block = [&](size_t controller, size_t block) //allocated by the first task to claim the block
+			{
+				auto& scores = known[controller];
+				std::scoped_lock lock(scores.mutex_);
+
+				auto& stored = scores.blocks_[block];
+				if (!stored) stored = std::make_unique<std::atomic<std::uint8_t>[]>(games_per_block);
+				return stored.get();
+			};
+
+			const auto score_of = [&](size_t controller, std::atomic<std::uint8_t>& known, std::uint64_t game_index)
+			{
+				if (const auto stored = known.load(std::memory_order_relaxed); stored != 0) return stored - 1;
+
+				const auto score = self_play[controller](chosen.base_seed_, game_index, chosen.controllers_);
+				known.store(static_cast<std::uint8_t>(score + 1), std::memory_order_relaxed);
+				return score;
+			};
+
+			const auto add_block = [&](pairing& played, size_t block, const block_sums& sums)
+			{
+				std::scoped_lock lock(played.mutex_);
+				played.blocks_[block] = sums;
+
+				while (!played.decided_ && played.num_added_ < played.blocks_.size() && played.blocks_[played.num_added_].has_value())
+				{
+					const auto& added = played.blocks_[played.num_added_++].value();
+					auto& total = played.total_;
+
+					total.num_games_ += added.num_games_;
+					total.first_ += added.first_;
+					total.second_ += added.second_;
+					total.difference_ += added.difference_;
+					total.difference_squared_ += added.difference_squared_;
+
+					const auto n = static_cast<double>(total.num_games_);
+					const auto mean_difference = total.difference_ / n;
+					const auto variance = n > 1 ? std::max(0.0, (total.difference_squared_ - n * mean_difference * mean_difference) / (n - 1)) : 0.0;
+					const auto half_width = chosen.z_ * std::sqrt(variance / n);
+
+					auto& settled = played.result_;
+					settled.num_games_ = total.num_games_;
+					settled.mean_first_ = total.first_ / n;
+					settled.mean_second_ = total.second_ / n;
+					settled.mean_difference_ = mean_difference;
+					settled.half_width_ = half_width;
+
+					const bool last = played.num_added_ == played.blocks_.size();
+					settled.stopped_early_ = !last && total.num_games_ >= chosen.min_games_ && half_width <= chosen.half_width_;
+					if (last || settled.stopped_early_) played.decided_ = true;
+				}
+			};
+
+			{
+				std::vector<std::jthread> workers;
+
+				for (unsigned worker = 0; worker < num_workers; ++worker)
+				{
+					workers.emplace_back([&, worker]()
+					{
+						while (const auto next = queues.take(worker))
+						{
+							auto& played = pairings[next->pairing_];
+							if (played.decided_) continue;
+
+							const auto [first, second] = pairs[next->pairing_];
+							const auto begin = next->block_ * games_per_block;
+							const auto end = std::min<std::uint64_t>(chosen.max_games_, begin + games_per_block);
+							const auto known_first = known_block(first, next->block_);
+							const auto known_second = known_block(second, next->block_);
+
+							block_sums sums;
+							for (auto game_index = begin; game_index < end; ++game_index)
+							{
+								const double first_score = score_of(first, known_first[game_index - begin], game_index);
+								const double second_score = score_of(second, known_second[game_index - begin], game_index);
+
+								++sums.num_games_;
+								sums.first_ += first_score;
+								sums.second_ += second_score;
+								sums.difference_ += first_score - second_score;
+								sums.difference_squared_ += (first_score - second_score) * (first_score - second_score);
+							}
+
+							add_block(played, next->block_, sums);
+						}
+					});
+				}
+			}
+
+			std::vector<result> results;
+			for (size_t p = 0; p < pairs.size(); ++p)
+			{
+				auto settled = pairings[p].result_;
+				settled.first_ = pairs[p].first;
+				settled.second_ = pairs[p].second;
+				results.push_back(settled);
+			}
+
+			return results;
+		}
+	}
+
+	namespace lockstep //many independent games in structure of arrays form, all advanced by one turn per step
+	{
+		namespace simd //registers of byte lanes, masks hold 0xFF in selected lanes and 0x00 in the others
+		{
+#if defined(__AVX2__)
+			using bytes = __m256i;
+			inline constexpr size_t width = 32;
+
+			inline bytes load(const std::uint8_t* from) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from)); }
+			inline void store(std::uint8_t* to, bytes value) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(to), value); }
+			inline bytes splat(std::uint8_t value) noexcept { return _mm256_set1_epi8(static_cast<char>(value)); }
+			inline bytes equal(bytes a, bytes b) noexcept { return _mm256_cmpeq_epi8(a, b); }
+			inline bytes both(bytes a, bytes b) noexcept { return _mm256_and_si256(a, b); }
+			inline bytes either(bytes a, bytes b) noexcept { return _mm256_or_si256(a, b); }
+			inline bytes except(bytes a, bytes mask) noexcept { return _mm256_andnot_si256(mask, a); }
+			inline bytes select(bytes a, bytes b, bytes mask) noexcept { return _mm256_blendv_epi8(a, b, mask); } //b where mask is set
+			inline bytes add(bytes a, bytes b) noexcept { return _mm256_add_epi8(a, b); }
+			inline bytes subtract(bytes a, bytes b) noexcept { return _mm256_sub_epi8(a, b); }
+			inline bytes minimum(bytes a, bytes b) noexcept { return _mm256_min_epu8(a, b); }
+			inline bytes high_nibble(bytes a) noexcept { return _mm256_and_si256(_mm256_srli_epi16(a, 4), _mm256_set1_epi8(0x0F)); }
+			inline bytes low_nibble(bytes a) noexcept { return _mm256_and_si256(a, _mm256_set1_epi8(0x0F)); }
+			inline bool any(bytes mask) noexcept { return _mm256_movemask_epi8(mask) != 0; }
+
+			inline bytes gather(const std::uint8_t* base, size_t stride, const std::uint8_t* offsets) noexcept //base[lane * stride + offsets[lane]], reads 4 bytes per lane
+			{
+				const auto strides = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride)));
+
+				const auto gather_eight = [&](size_t first)
+				{
+					const auto index = _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(offsets + first))), strides);
+					return _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(base + first * stride), index, 1), _mm256_set1_epi32(0xFF));
+				};
+
+				//the packs work within each 128 bit half, the permute puts the four groups of eight lanes back in order
+				const auto packed = _mm256_packus_epi16(_mm256_packus_epi32(gather_eight(0), gather_eight(8)), _mm256_packus_epi32(gather_eight(16), gather_eight(24)));
+				return _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+			}
+#elif defined(__SSE2__) || defined(_M_X64)
+			using bytes = __m128i;
+			inline constexpr size_t width = 16;
+
+			inline bytes load(const std::uint8_t* from) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(from)); }
+			inline void store(std::uint8_t* to, bytes value) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(to), value); }
+			inline bytes splat(std::uint8_t value) noexcept { return _mm_set1_epi8(static_cast<char>(value)); }
+			inline bytes equal(bytes a, bytes b) noexcept { return _mm_cmpeq_epi8(a, b); }
+			inline bytes both(bytes a, bytes b) noexcept { return _mm_and_si128(a, b); }
+			inline bytes either(bytes a, bytes b) noexcept { return _mm_or_si128(a, b); }
+			inline bytes except(bytes a, bytes mask) noexcept { return _mm_andnot_si128(mask, a); }
+			inline bytes select(bytes a, bytes b, bytes mask) noexcept { return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b)); } //b where mask is set
+			inline bytes add(bytes a, bytes b) noexcept { return _mm_add_epi8(a, b); }
+			inline bytes subtract(bytes a, bytes b) noexcept { return _mm_sub_epi8(a, b); }
+			inline bytes minimum(bytes a, bytes b) noexcept { return _mm_min_epu8(a, b); }
+			inline bytes high_nibble(bytes a) noexcept { return _mm_and_si128(_mm_srli_epi16(a, 4), _mm_set1_epi8(0x0F)); }
+			inline bytes low_nibble(bytes a) noexcept { return _mm_and_si128(a, _mm_set1_epi8(0x0F)); }
+			inline bool any(bytes mask) noexcept { return _mm_movemask_epi8(mask) != 0; }
+#else
+			using bytes = std::uint8_t;
+			inline constexpr size_t width = 1;
+
+			inline bytes load(const std::uint8_t* from) noexcept { return *from; }
+			inline void store(std::uint8_t* to, bytes value) noexcept { *to = value; }
+			inline bytes splat(std::uint8_t value) noexcept { return value; }
+			inline bytes equal(bytes a, bytes b) noexcept { return a == b ? 0xFF : 0x00; }
+			inline bytes both(bytes a, bytes b) noexcept { return a & b; }
+			inline bytes either(bytes a, bytes b) noexcept { return a | b; }
+			inline bytes except(bytes a, bytes mask) noexcept { return a & static_cast<bytes>(~mask); }
+			inline bytes select(bytes a, bytes b, bytes mask) noexcept { return mask ? b : a; } //b where mask is set
+			inline bytes add(bytes a, bytes b) noexcept { return static_cast<bytes>(a + b); }
+			inline bytes subtract(bytes a, bytes b) noexcept { return static_cast<bytes>(a - b); }
+			inline bytes minimum(bytes a, bytes b) noexcept { return std::min(a, b); }
+			inline bytes high_nibble(bytes a) noexcept { return a >> 4; }
+			inline bytes low_nibble(bytes a) noexcept { return a & 0x0F; }
+			inline bool any(bytes mask) noexcept { return mask != 0; }
+#endif
+
+#if !defined(__AVX2__)
+			inline bytes gather(const std::uint8_t* base, size_t stride, const std::uint8_t* offsets) noexcept //base[lane * stride + offsets[lane]], no byte gather below avx2
+			{
+				std::array<std::uint8_t, width> gathered;
+				for (size_t lane = 0; lane < width; ++lane) gathered[lane] = base[lane * stride + offsets[lane]];
+				return load(gathered.data());
+			}
+#endif
+		}
+
+		enum class move_kind : std::uint8_t { play, discard, hint_color, hint_rank };
+
+		template <size_t Lanes>
+		struct moves //one move per lane, laid out like the games
+		{
+			std::array<std::uint8_t, Lanes> kind_; //move_kind
+			std::array<std::uint8_t, Lanes> argument_; //hand slot for plays and discards, color or rank index for hints
+			std::array<std::uint8_t, Lanes> target_; //hinted player as a number of seats after the player to move
+		};
+
+		template <typename Configuration, size_t Lanes = 256>
+		class engine //step follows the rules of play::apply, discard::apply and hint::apply, for moves that are legal in their lane
+		{
+		public:
+
+			using configuration_t = typename configuration::configuration_traits<Configuration>;
+
+			static_assert(Lanes % simd::width == 0, "Lanes must fill whole registers.");
+			static_assert(configuration_t::num_colors < 16 && configuration_t::num_ranks < 16, "Cards are packed as a color nibble and a rank nibble.");
+
+			static constexpr std::uint8_t no_card = 0xFF;
+
+			engine()
+			{
+				over_.fill(0xFF); //lanes without a game never step
+			}
+
+			void assign(size_t lane, const game_state<Configuration>& state) //replaces the game in lane
+			{
+				for (size_t player = 0; player < configuration_t::num_players; ++player)
+				{
+					const auto hand = state.hand_of(static_cast<int>(player));
+
+					for (size_t slot = 0; slot < configuration_t::hand_size; ++slot)
+					{
+						const auto known = slot < hand.size() ? state.deck_.cards_[hand[slot]].knowledge_ : knowledge<Configuration>{};
+
+						hands_[player][slot][lane] = slot < hand.size() ? pack(state.deck_.cards_[hand[slot]].identity_) : no_card;
+						hinted_colors_[player][slot][lane] = known.hinted_colors_;
+						hinted_ranks_[player][slot][lane] = known.hinted_ranks_;
+					}
+				}
+
+				const auto deck = decks_.begin() + lane * deck_stride;
+				std::transform(state.deck_.cards_.begin(), state.deck_.cards_.end(), deck, [](const auto& card_in_deck) { return pack(card_in_deck.identity_); });
+				std::fill(deck + configuration_t::deck_size, deck + deck_stride, no_card); //drawing from an empty deck gathers no_card
+
+				for (size_t color = 0; color < configuration_t::num_colors; ++color) fireworks_[color][lane] = state.fireworks_[color];
+
+				num_available_hints_[lane] = static_cast<std::uint8_t>(state.num_available_hints_);
+				num_mistakes_[lane] = static_cast<std::uint8_t>(state.num_mistakes_);
+				player_turn_[lane] = static_cast<std::uint8_t>(state.player_turn_);
+				next_card_to_draw_[lane] = static_cast<std::uint8_t>(state.next_card_to_draw_.value_or(configuration_t::deck_size));
+				last_player_to_play_[lane] = static_cast<std::uint8_t>(state.last_player_to_play_.value_or(configuration_t::num_players));
+				over_[lane] = state.is_over() ? 0xFF : 0x00;
+			}
+
+			bool is_over(size_t lane) const noexcept
+			{
+				return over_[lane] != 0;
+			}
+
+			bool all_over() const noexcept
+			{
+				for (size_t first = 0; first < Lanes; first += simd::width)
+				{
+					if (simd::any(simd::equal(simd::load(&over_[first]), simd::splat(0)))) return false;
+				}
+
+				return true;
+			}
+
+			int score(size_t lane) const noexcept
+			{
+				int total = 0;
+				for (const auto& firework : fireworks_) total += firework[lane];
+				return total;
+			}
+
+			template <typename Gen>
+			void choose_random(Gen& gen, moves<Lanes>& chosen) const //uniform over the legal moves of each running lane, in the order of for_each_possible_action
+			{
+				for (size_t lane = 0; lane < Lanes; ++lane)
+				{
+					if (is_over(lane)) continue;
+
+					const auto& hand = hands_[player_turn_[lane]];
+					const auto hand_size = static_cast<size_t>(std::count_if(hand.begin(), hand.end(), [&](const auto& slot) { return slot[lane] != no_card; }));
+
+					std::array<std::uint8_t, 2 * configuration_t::num_players> possible_hints{}; //colors then ranks present in the hand of each target
+					size_t num_hints = 0;
+
+					for (size_t target = 1; num_available_hints_[lane] > 0 && target < configuration_t::num_players; ++target)
+					{
+						for (const auto& slot : hands_[(player_turn_[lane] + target) % configuration_t::num_players])
+						{
+							if (slot[lane] == no_card) continue;
+							possible_hints[2 * target] |= static_cast<std::uint8_t>(1u << (slot[lane] >> 4));
+							possible_hints[2 * target + 1] |= static_cast<std::uint8_t>(1u << (slot[lane] & 0x0F));
+						}
+
+						num_hints += std::popcount(possible_hints[2 * target]) + std::popcount(possible_hints[2 * target + 1]);
+					}
+
+					std::uniform_int_distribution<size_t> dis(0, 2 * hand_size + num_hints - 1);
+					auto choice = dis(gen);
+
+					if (choice < 2 * hand_size)
+					{
+						chosen.kind_[lane] = static_cast<std::uint8_t>(choice % 2 == 0 ? move_kind::play : move_kind::discard);
+						chosen.argument_[lane] = static_cast<std::uint8_t>(choice / 2);
+						continue;
+					}
+
+					choice -= 2 * hand_size;
+
+					for (size_t hints = 2; hints < possible_hints.size(); ++hints)
+					{
+						const auto num_possible = static_cast<size_t>(std::popcount(possible_hints[hints]));
+
+						if (choice >= num_possible)
+						{
+							choice -= num_possible;
+							continue;
+						}
+
+						auto remaining = possible_hints[hints];
+						for (; choice > 0; --choice) remaining &= static_cast<std::uint8_t>(remaining - 1); //drop the lowest properties
+
+						chosen.kind_[lane] = static_cast<std::uint8_t>(hints % 2 == 0 ? move_kind::hint_color : move_kind::hint_rank);
+						chosen.argument_[lane] = static_cast<std::uint8_t>(std::countr_zero(remaining));
+						chosen.target_[lane] = static_cast<std::uint8_t>(hints / 2);
+						break;
+					}
+				}
+			}
+
+			void step(const moves<Lanes>& chosen)
+			{
+				using namespace simd;
+
+				const auto one = splat(1);
+
+				for (size_t first = 0; first < Lanes; first += width)
+				{
+					const auto active = equal(load(&over_[first]), splat(0));
+					const auto kind = load(&chosen.kind_[first]);
+					const auto argument = load(&chosen.argument_[first]);
+					const auto turn = load(&player_turn_[first]);
+
+					const auto is_play = both(active, equal(kind, splat(static_cast<std::uint8_t>(move_kind::play))));
+					const auto is_discard = both(active, equal(kind, splat(static_cast<std::uint8_t>(move_kind::discard))));
+					const auto is_color_hint = both(active, equal(kind, splat(static_cast<std::uint8_t>(move_kind::hint_color))));
+					const auto is_rank_hint = both(active, equal(kind, splat(static_cast<std::uint8_t>(move_kind::hint_rank))));
+					const auto is_hint = either(is_color_hint, is_rank_hint);
+					const auto leaves_hand = either(is_play, is_discard);
+
+					auto acted_card = splat(no_card);
+
+					for (size_t player = 0; player < configuration_t::num_players; ++player)
+					{
+						const auto is_turn = equal(turn, splat(static_cast<std::uint8_t>(player)));
+
+						for (size_t slot = 0; slot < configuration_t::hand_size; ++slot)
+						{
+							acted_card = select(acted_card, load(&hands_[player][slot][first]), both(is_turn, equal(argument, splat(static_cast<std::uint8_t>(slot)))));
+						}
+					}
+
+					const auto acted_color = high_nibble(acted_card);
+					const auto acted_rank = low_nibble(acted_card);
+
+					auto firework = splat(0);
+					for (size_t color = 0; color < configuration_t::num_colors; ++color)
+					{
+						firework = select(firework, load(&fireworks_[color][first]), equal(acted_color, splat(static_cast<std::uint8_t>(color))));
+					}
+
+					const auto succeeded = both(is_play, equal(firework, acted_rank));
+					const auto failed = except(is_play, succeeded);
+
+					auto score = splat(0);
+					for (size_t color = 0; color < configuration_t::num_colors; ++color)
+					{
+						const auto advanced = both(succeeded, equal(acted_color, splat(static_cast<std::uint8_t>(color))));
+						const auto updated = add(load(&fireworks_[color][first]), both(advanced, one));
+
+						store(&fireworks_[color][first], updated);
+						score = add(score, updated);
+					}
+
+					const auto mistakes = add(load(&num_mistakes_[first]), both(failed, one));
+					store(&num_mistakes_[first], mistakes);
+
+					const auto completed_firework = both(succeeded, equal(acted_rank, splat(static_cast<std::uint8_t>(configuration_t::num_ranks - 1))));
+					const auto hints = minimum(add(load(&num_available_hints_[first]), both(either(is_discard, completed_firework), one)), splat(static_cast<std::uint8_t>(Configuration::max_num_hints)));
+					store(&num_available_hints_[first], subtract(hints, both(is_hint, one)));
+
+					const auto next_card = load(&next_card_to_draw_[first]);
+					const auto deck_was_empty = equal(next_card, splat(static_cast<std::uint8_t>(configuration_t::deck_size)));
+					const auto draws = except(leaves_hand, deck_was_empty);
+					const auto drawn_card = gather(&decks_[first * deck_stride], deck_stride, &next_card_to_draw_[first]);
+					const auto next_card_after = add(next_card, both(draws, one));
+					store(&next_card_to_draw_[first], next_card_after);
+
+					const auto drew_last_card = both(draws, equal(next_card_after, splat(static_cast<std::uint8_t>(configuration_t::deck_size))));
+					const auto last_player = select(load(&last_player_to_play_[first]), turn, drew_last_card);
+					store(&last_player_to_play_[first], last_player);
+
+					auto hinted_player = add(turn, load(&chosen.target_[first]));
+					hinted_player = select(hinted_player, subtract(hinted_player, splat(configuration_t::num_players)), equal(minimum(hinted_player, splat(configuration_t::num_players)), splat(configuration_t::num_players)));
+
+					auto hinted_bit = splat(0);
+					for (size_t property = 0; property < std::max(configuration_t::num_colors, configuration_t::num_ranks); ++property)
+					{
+						hinted_bit = select(hinted_bit, splat(static_cast<std::uint8_t>(1u << property)), equal(argument, splat(static_cast<std::uint8_t>(property))));
+					}
+
+					for (size_t player = 0; player < configuration_t::num_players; ++player)
+					{
+						const auto removes = both(leaves_hand, equal(turn, splat(static_cast<std::uint8_t>(player))));
+						const auto hinted = both(is_hint, equal(hinted_player, splat(static_cast<std::uint8_t>(player))));
+						auto& hand = hands_[player];
+
+						for (size_t slot = 0; slot < configuration_t::hand_size; ++slot)
+						{
+							const bool newest = slot + 1 == configuration_t::hand_size; //a full hand draws into its newest slot
+							const auto shifts = both(removes, equal(minimum(argument, splat(static_cast<std::uint8_t>(slot))), argument));
+							const auto card = load(&hand[slot][first]);
+
+							const auto color_matches = equal(high_nibble(card), argument);
+							const auto rank_matches = equal(low_nibble(card), argument);
+							auto colors = load(&hinted_colors_[player][slot][first]);
+							auto ranks = load(&hinted_ranks_[player][slot][first]);
+
+							colors = select(colors, select(except(colors, hinted_bit), hinted_bit, color_matches), both(hinted, is_color_hint));
+							ranks = select(ranks, select(except(ranks, hinted_bit), hinted_bit, rank_matches), both(hinted, is_rank_hint));
+
+							const auto shifted_card = newest ? select(splat(no_card), drawn_card, draws) : load(&hand[slot + 1][first]);
+							const auto shifted_colors = newest ? splat(knowledge<Configuration>::all_colors) : load(&hinted_colors_[player][slot + 1][first]);
+							const auto shifted_ranks = newest ? splat(knowledge<Configuration>::all_ranks) : load(&hinted_ranks_[player][slot + 1][first]);
+
+							store(&hand[slot][first], select(card, shifted_card, shifts));
+							store(&hinted_colors_[player][slot][first], select(colors, shifted_colors, shifts));
+							store(&hinted_ranks_[player][slot][first], select(ranks, shifted_ranks, shifts));
+						}
+					}
+
+					//end_turn, then the checks of game_state::is_over
+					const auto last_turn_played = both(active, both(deck_was_empty, equal(last_player, turn)));
+					const auto next_turn = add(turn, one);
+					store(&player_turn_[first], select(turn, select(next_turn, splat(0), equal(next_turn, splat(configuration_t::num_players))), active));
+
+					auto over = either(load(&over_[first]), last_turn_played);
+					over = either(over, equal(mistakes, splat(static_cast<std::uint8_t>(configuration_t::max_num_mistakes))));
+					over = either(over, equal(score, splat(static_cast<std::uint8_t>(configuration_t::max_score))));
+					store(&over_[first], over);
+				}
+			}
+
+		private:
+
+			using lane_t = std::array<std::uint8_t, Lanes>;
+			using hand_lanes_t = std::array<std::array<lane_t, configuration_t::hand_size>, configuration_t::num_players>;
+
+			static constexpr size_t deck_stride = configuration_t::deck_size + 4; //a gathered draw reads 4 bytes from the draw position
+
+			static constexpr std::uint8_t pack(std::uint8_t identity) noexcept
+			{
+				return static_cast<std::uint8_t>((identity / configuration_t::num_ranks) << 4 | identity % configuration_t::num_ranks);
+			}
+
+			hand_lanes_t hands_{}; //color << 4 | rank of each card in hand, oldest draw first, empty slots hold no_card
+			hand_lanes_t hinted_colors_{};
+			hand_lanes_t hinted_ranks_{};
+			std::array<lane_t, configuration_t::num_colors> fireworks_{};
+			lane_t num_available_hints_{};
+			lane_t num_mistakes_{};
+			lane_t player_turn_{};
+			lane_t next_card_to_draw_{}; //deck_size once the deck is empty
+			lane_t last_player_to_play_{}; //num_players until the last card is drawn
+			lane_t over_{};
+			std::array<std::uint8_t, Lanes * deck_stride> decks_{}; //the whole deck of each lane, in draw order
+		};
+
+		template <typename Configuration, size_t Lanes = 256>
+		batch::statistics<Configuration> play_stream(std::uint32_t base_seed, std::uint64_t stream, std::uint64_t num_games) //random play, lanes are dealt a new game as soon as theirs ends
+		{
+			auto gen = batch::stream_generator(base_seed, stream);
+			auto games = std::make_unique<engine<Configuration, Lanes>>();
+			auto chosen = std::make_unique<moves<Lanes>>();
+			std::array<bool, Lanes> in_use{};
+			std::uint64_t num_dealt = 0;
+
+			batch::statistics<Configuration> stats;
+			stats.num_games_ = num_games;
+
+			for (size_t lane = 0; lane < Lanes && num_dealt < num_games; ++lane, ++num_dealt)
+			{
+				games->assign(lane, game<Configuration>::deal(gen));
+				in_use[lane] = true;
+			}
+
+			while (!games->all_over())
+			{
+				games->choose_random(gen, *chosen);
+				games->step(*chosen);
+
+				for (size_t lane = 0; lane < Lanes; ++lane)
+				{
+					if (!in_use[lane] || !games->is_over(lane)) continue;
+
+					++stats.score_histogram_[games->score(lane)];
+
+					if (num_dealt < num_games)
+					{
+						games->assign(lane, game<Configuration>::deal(gen));
+						++num_dealt;
+					}
+					else
+					{
+						in_use[lane] = false;
+					}
+				}
+			}
+
+			return stats;
+		}
+
+		template <typename Configuration, size_t Lanes = 256>
+		batch::statistics<Configuration> run(std::uint64_t num_games, std::uint32_t base_seed, unsigned num_threads)
+		{
+			return batch::run_streams<Configuration>(num_games, num_threads, [base_seed](std::uint64_t stream, std::uint64_t games_this_stream)
+				{
+					return play_stream<Configuration, Lanes>(base_seed, stream, games_this_stream);
+				});
+		}
+	}
+
+	namespace solver
+	{
+		struct result
+		{
+			int score_; //best score found
+			int upper_bound_; //no line of play from the deal scores more than this
+			bool exact_; //the search finished within its node budget, so score_ is the maximum achievable score
+			std::uint64_t nodes_;
+		};
+
+		template <typename Configuration>
+		class open_hand //finds the best score of a deal when every player sees every card, including the order of the draw pile
+		{
+		public:
+
+			using configuration_t = typename configuration::configuration_traits<Configuration>;
+			using actions_t = typename Configuration::template actions<std::variant>;
+
+			explicit open_hand(std::uint64_t node_budget = 20'000'000, unsigned table_bits = 22) : node_budget_(node_budget), table_(size_t{ 1 } << table_bits)
+			{
+			}
+
+			result solve(const game_state<Configuration>& deal)
+			{
+				std::fill(table_.begin(), table_.end(), table_entry{});
+				nodes_ = 0;
+				best_found_ = deal.score();
+
+				auto state = deal;
+				int bound = upper_bound(state);
+
+				for (auto greedy = deal; !greedy.is_over();) //a quick line of play gives a score to beat
+				{
+					std::visit([&](const auto& a) { a.apply(greedy); }, candidate_actions(greedy)[0]);
+					best_found_ = std::max(best_found_, greedy.score());
+				}
+
+				for (int target = bound; target > best_found_; target = bound) //asks whether target is reachable, best first
+				{
+					const int value = search(state, target - 1);
+					if (nodes_ > node_budget_) return { best_found_, bound, false, nodes_ };
+
+					if (value >= target) return { value, value, true, nodes_ };
+					bound = value; //a fail low bounds the score from above, so the targets in between are skipped
+				}
+
+				return { best_found_, best_found_, true, nodes_ };
+			}
+
+			//every missing card must still exist and be played in time. While cards are left to draw, time is counted in plays and discards
+			//(hints draw nothing, so they do not bring a card closer), and at most num_players turns follow the last draw
+			static int upper_bound(const game_state<Configuration>& state)
+			{
+				constexpr int num_players = static_cast<int>(configuration_t::num_players);
+				const bool deck_is_empty = !state.next_card_to_draw_.has_value();
+				const int first_in_draw_pile = state.next_card_to_draw_.value_or(static_cast<int>(configuration_t::deck_size));
+
+				const int plays_left = deck_is_empty
+					? (state.last_player_to_play_.value() - state.player_turn_ + num_players) % num_players + 1
+					: static_cast<int>(configuration_t::deck_size) - first_in_draw_pile + num_players;
+
+				std::array<int, configuration_t::num_colors * configuration_t::num_ranks> earliest_play; //the next play or discard is 1
+				earliest_play.fill(std::numeric_limits<int>::max());
+
+				for (int player = 0; player < num_players; ++player)
+				{
+					for (const auto card_in_hand : state.hand_of(player))
+					{
+						auto& earliest = earliest_play[state.deck_.cards_[card_in_hand].identity_];
+						earliest = std::min(earliest, deck_is_empty ? (player - state.player_turn_ + num_players) % num_players + 1 : 1);
+					}
+				}
+
+				for (int position = first_in_draw_pile; position < static_cast<int>(configuration_t::deck_size); ++position)
+				{
+					auto& earliest = earliest_play[state.deck_.cards_[position].identity_];
+					earliest = std::min(earliest, position - first_in_draw_pile + 2); //drawn by one play or discard, played by a later one
+				}
+
+				int reachable = 0;
+
+				for (size_t color = 0; color < configuration_t::num_colors; ++color)
+				{
+					for (int rank = state.fireworks_[color], when = 0; rank < static_cast<int>(configuration_t::num_ranks); ++rank)
+					{
+						when = std::max(when + 1, earliest_play[color * configuration_t::num_ranks + rank]);
+						if (when > plays_left) break;
+
+						++reachable;
+					}
+				}
+
+				return state.score() + std::min(reachable, plays_left);
+			}
+
+		private:
+
+			struct table_entry
+			{
+				std::uint64_t key_ = 0;
+				std::int8_t value_ = -1;
+				bool exact_ = false; //otherwise value_ is an upper bound
+			};
+
+			//plays of playable cards first, then a single hint (every hint is equivalent with open hands), then discards, dead cards first.
+			//playing an unplayable card is never better than discarding it, and identical cards in a hand are interchangeable
+			static auto candidate_actions(const game_state<Configuration>& state)
+			{
+				inline_vector<actions_t, 2 * configuration_t::hand_size + 1> candidates;
+				const auto hand = state.hand_of(state.player_turn_);
+
+				const auto has_twin_before = [&](size_t slot)
+				{
+					return std::any_of(hand.begin(), hand.begin() + slot, [&](std::uint8_t other) { return state.deck_.cards_[other].identity_ == state.deck_.cards_[hand[slot]].identity_; });
+				};
+
+				for (size_t slot = 0; slot < hand.size(); ++slot)
+				{
+					if (play{ hand[slot] }.is_playable(state) && !has_twin_before(slot)) candidates.emplace_back(action{ play{ hand[slot] } });
+				}
+
+				if (state.num_available_hints_ > 0)
+				{
+					bool found_hint = false;
+
+					for_each_possible_action(state, [&](const auto& possible_action)
+						{
+							using action_t = std::remove_cvref_t<decltype(possible_action)>;
+
+							if constexpr (!std::is_same_v<action_t, action<play>> && !std::is_same_v<action_t, action<discard>>)
+							{
+								if (!found_hint) candidates.emplace_back(possible_action);
+								found_hint = true;
+							}
+						});
+				}
+
+				for (const bool dead : { true, false })
+				{
+					for (size_t slot = 0; slot < hand.size(); ++slot)
+					{
+						const auto& card_in_deck = state.deck_.cards_[hand[slot]];
+						const bool is_dead = card_in_deck.rank_index() < state.fireworks_[card_in_deck.color_index()];
+
+						if (is_dead == dead && !has_twin_before(slot)) candidates.emplace_back(action{ discard{ hand[slot] } });
+					}
+				}
+
+				return candidates;
+			}
+
+			//knowledge does not matter with open hands, so states that only differ by the hints given share a table entry
+			template <typename Action>
+			static std::uint64_t knowledge_changes(const game_state<Configuration>& state, const Action&, const undo_record<Configuration>& record)
+			{
+				std::uint64_t changes = 0;
+
+				if constexpr (!std::is_same_v<Action, action<play>> && !std::is_same_v<Action, action<discard>>)
+				{
+					for (size_t slot = 0; slot < record.hand_size_; ++slot)
+					{
+						const auto card = record.hand_[slot];
+						changes ^= zobrist<Configuration>::knowledge_change(card, record.knowledge_[slot], state.deck_.cards_[card].knowledge_);
+					}
+				}
+
+				return changes;
+			}
+
+			int search(game_state<Configuration>& state, int alpha) //exact value if it is above alpha, otherwise an upper bound at most alpha
+			{
+				++nodes_;
+
+				if (state.is_over())
+				{
+					best_found_ = std::max(best_found_, state.score());
+					return state.score();
+				}
+
+				int bound = upper_bound(state);
+				if (bound <= alpha || nodes_ > node_budget_) return bound;
+
+				const auto key = (state.hash_ ^ knowledge_changes_) | 1; //0 marks an empty entry
+				auto& entry = table_[key & (table_.size() - 1)];
+
+				if (entry.key_ == key)
+				{
+					if (entry.exact_) return entry.value_;
+
+					bound = std::min<int>(bound, entry.value_);
+					if (bound <= alpha) return bound;
+				}
+
+				int best = -1;
+
+				for (const auto& candidate : candidate_actions(state))
+				{
+					const int value = std::visit([&](const auto& a)
+						{
+							const auto record = a.apply(state);
+							const auto changes = knowledge_changes(state, a, record);
+
+							knowledge_changes_ ^= changes;
+							const int child_value = search(state, std::max(alpha, best));
+							knowledge_changes_ ^= changes;
+
+							a.undo(state, record);
+							return child_value;
+						}, candidate);
+
+					best = std::max(best, value);
+					if (best >= bound) break;
+				}
+
+				if (nodes_ <= node_budget_)
+				{
+					table_[key & (table_.size() - 1)] = table_entry{ key, static_cast<std::int8_t>(best), best > alpha };
+				}
+
+				return best;
+			}
+
+			std::uint64_t node_budget_;
+			std::uint64_t nodes_ = 0;
+			std::uint64_t knowledge_changes_ = 0;
+			int best_found_ = 0;
+			std::vector<table_entry> table_;
+		};
+
+		template <typename Configuration>
+		std::vector<result> solve_seeds(const std::vector<std::uint32_t>& seeds, unsigned num_threads, std::uint64_t node_budget = 20'000'000)
+		{
+			std::vector<result> results(seeds.size());
+			std::atomic<size_t> next_seed = 0;
+
+			std::vector<std::jthread> workers;
+
+			for (unsigned worker = 0; worker < std::max(1u, num_threads); ++worker)
+			{
+				workers.emplace_back([&]()
+				{
+					open_hand<Configuration> solver(node_budget);
+
+					for (auto i = next_seed++; i < seeds.size(); i = next_seed++)
+					{
+						std::mt19937 gen(seeds[i]);
+						results[i] = solver.solve(game<Configuration>::deal(gen));
+					}
+				});
+			}
+
+			return results;
+		}
+	}
+}
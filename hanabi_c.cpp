@@ -0,0 +1,169 @@
+#include "hanabi_c.h"
+#include "hanabi.hpp"
+
+namespace
+{
+	template <typename Configuration>
+	class environments //every game of one table size, stepped one chunk at a time
+	{
+	public:
+
+		using encoder_t = hanabi::observation_encoder<Configuration>;
+		using actions_t = hanabi::relative_action<Configuration>;
+
+		environments(size_t num_envs, std::uint32_t seed) : states_(num_envs), last_(num_envs), episodes_(num_envs, 0), seed_(seed)
+		{
+			for (size_t env = 0; env < num_envs; ++env) deal(env);
+		}
+
+		void reset(size_t env, float* observations, std::uint8_t* legal_actions)
+		{
+			deal(env);
+			write(env, observations, legal_actions);
+		}
+
+		bool step(size_t env, std::int32_t chosen, float* observations, std::uint8_t* legal_actions, float* rewards, std::uint8_t* dones)
+		{
+			auto& state = states_[env];
+			const auto taken = chosen >= 0 ? actions_t::action_at(state, static_cast<size_t>(chosen)) : std::nullopt;
+			const bool accepted = taken.has_value() && std::visit([&](const auto& a) { return a.validate(state); }, taken.value());
+
+			const auto score_before = state.score();
+			bool done = false;
+
+			if (accepted)
+			{
+				last_[env] = hanabi::observed_action<Configuration>::of(state, taken.value());
+				std::visit([&](const auto& a) { a.apply(state); }, taken.value());
+				done = state.is_over();
+			}
+
+			if (rewards != nullptr) rewards[env] = static_cast<float>(state.score() - score_before);
+			if (dones != nullptr) dones[env] = done;
+
+			if (done) deal(env);
+			write(env, observations, legal_actions);
+
+			return accepted;
+		}
+
+	private:
+
+		void deal(size_t env)
+		{
+			auto gen = hanabi::rng::for_game(seed_, (static_cast<std::uint64_t>(env) << 32) | episodes_[env]++);
+			states_[env] = hanabi::game<Configuration>::deal(gen);
+			last_[env] = {};
+		}
+
+		void write(size_t env, float* observations, std::uint8_t* legal_actions) const
+		{
+			const auto& state = states_[env];
+
+			if (observations != nullptr)
+			{
+				encoder_t::encode(state, state.player_turn_, last_[env], std::span<float, encoder_t::size>(observations + env * encoder_t::size, encoder_t::size));
+			}
+
+			if (legal_actions != nullptr)
+			{
+				actions_t::legal(state, std::span<std::uint8_t, actions_t::num_actions>(legal_actions + env * actions_t::num_actions, actions_t::num_actions));
+			}
+		}
+
+		std::vector<hanabi::game_state<Configuration>> states_;
+		std::vector<hanabi::observed_action<Configuration>> last_;
+		std::vector<std::uint32_t> episodes_;
+		std::uint32_t seed_;
+	};
+
+	using tables_t = std::variant<
+		environments<hanabi::configuration::default_t>,
+		environments<hanabi::configuration::players<3>>,
+		environments<hanabi::configuration::players<4>>,
+		environments<hanabi::configuration::players<5>>>;
+
+	inline constexpr size_t envs_per_chunk = 64;
+}
+
+struct hanabi_env
+{
+	hanabi_env(tables_t&& tables, size_t num_envs, unsigned num_threads) : tables_(std::move(tables)), num_envs_(num_envs), pool_(num_threads) {}
+
+	template <typename PerEnv> //per_env(tables, env) for every game, spread over the pool
+	void for_each_env(const PerEnv& per_env)
+	{
+		std::visit([&](auto& tables)
+		{
+			pool_.run((num_envs_ + envs_per_chunk - 1) / envs_per_chunk, [&](size_t chunk)
+				{
+					for (size_t env = chunk * envs_per_chunk; env < std::min(num_envs_, (chunk + 1) * envs_per_chunk); ++env) per_env(tables, env);
+				});
+		}, tables_);
+	}
+
+	tables_t tables_;
+	size_t num_envs_;
+	hanabi::parallel::worker_pool pool_;
+};
+
+extern "C"
+{
+	hanabi_env* hanabi_env_create(uint32_t num_players, uint32_t num_envs, uint32_t seed, uint32_t num_threads)
+	{
+		const auto threads = num_threads != 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+
+		try
+		{
+			switch (num_players)
+			{
+			case 2: return new hanabi_env(tables_t(std::in_place_index<0>, num_envs, seed), num_envs, threads);
+			case 3: return new hanabi_env(tables_t(std::in_place_index<1>, num_envs, seed), num_envs, threads);
+			case 4: return new hanabi_env(tables_t(std::in_place_index<2>, num_envs, seed), num_envs, threads);
+			case 5: return new hanabi_env(tables_t(std::in_place_index<3>, num_envs, seed), num_envs, threads);
+			default: return nullptr;
+			}
+		}
+		catch (const std::exception&)
+		{
+			return nullptr;
+		}
+	}
+
+	void hanabi_env_destroy(hanabi_env* env)
+	{
+		delete env;
+	}
+
+	uint32_t hanabi_env_num_envs(const hanabi_env* env)
+	{
+		return static_cast<uint32_t>(env->num_envs_);
+	}
+
+	uint32_t hanabi_env_observation_size(const hanabi_env* env)
+	{
+		return std::visit([] <typename Tables> (const Tables&) { return static_cast<uint32_t>(Tables::encoder_t::size); }, env->tables_);
+	}
+
+	uint32_t hanabi_env_num_actions(const hanabi_env* env)
+	{
+		return std::visit([] <typename Tables> (const Tables&) { return static_cast<uint32_t>(Tables::actions_t::num_actions); }, env->tables_);
+	}
+
+	void hanabi_env_reset(hanabi_env* env, float* observations, uint8_t* legal_actions)
+	{
+		env->for_each_env([&](auto& tables, size_t i) { tables.reset(i, observations, legal_actions); });
+	}
+
+	uint32_t hanabi_env_step(hanabi_env* env, const int32_t* actions, float* observations, uint8_t* legal_actions, float* rewards, uint8_t* dones)
+	{
+		std::atomic<uint32_t> num_ignored = 0;
+
+		env->for_each_env([&](auto& tables, size_t i)
+			{
+				if (!tables.step(i, actions[i], observations, legal_actions, rewards, dones)) num_ignored.fetch_add(1, std::memory_order_relaxed);
+			});
+
+		return num_ignored;
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef CPPHANABI_HANABI_C_H
+#define CPPHANABI_HANABI_C_H
+
+/* many games stepped together through one call, for trainers that load this library through a C foreign function interface */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(HANABI_C_BUILDING)
+#define HANABI_C_API __declspec(dllexport)
+#else
+#define HANABI_C_API __declspec(dllimport)
+#endif
+#else
+#define HANABI_C_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct hanabi_env hanabi_env;
+
+/*
+ * every buffer holds one row per game, back to back:
+ *   observations  float[num_envs][observation_size], the game as the player to act sees it, one 0 or 1 per feature
+ *   legal_actions uint8_t[num_envs][num_actions], 1 for every action the player to act may take
+ *   actions       int32_t[num_envs]
+ *   rewards       float[num_envs], points scored by the step
+ *   dones         uint8_t[num_envs], 1 when the step ended the game
+ *
+ * actions are numbered from the player to act: playing hand slot n is n, discarding it is hand_size + n,
+ * and hints follow at 2 * hand_size + (seats to the left - 1) * (num_colors + num_ranks) + property, colors before ranks.
+ *
+ * a game that ends is dealt again straight away, so the observation written for it belongs to the new game.
+ * every deal of game i comes from a generator keyed by (seed, i, episode), so results depend on the seed alone and not on the number of threads.
+ */
+
+/* num_players from 2 to 5, num_threads 0 for one per hardware thread. NULL if the table is not supported or memory ran out */
+HANABI_C_API hanabi_env* hanabi_env_create(uint32_t num_players, uint32_t num_envs, uint32_t seed, uint32_t num_threads);
+HANABI_C_API void hanabi_env_destroy(hanabi_env* env);
+
+HANABI_C_API uint32_t hanabi_env_num_envs(const hanabi_env* env);
+HANABI_C_API uint32_t hanabi_env_observation_size(const hanabi_env* env);
+HANABI_C_API uint32_t hanabi_env_num_actions(const hanabi_env* env);
+
+/* deals every game again. observations and legal_actions may be NULL */
+HANABI_C_API void hanabi_env_reset(hanabi_env* env, float* observations, uint8_t* legal_actions);
+
+/* takes one action in every game. illegal actions are ignored, that game does not move and gets no reward.
+ * returns the number of games whose action was ignored. observations and legal_actions may be NULL */
+HANABI_C_API uint32_t hanabi_env_step(hanabi_env* env, const int32_t* actions, float* observations, uint8_t* legal_actions, float* rewards, uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif